@@ -3,6 +3,7 @@
 #include "LyraGameplayAbility.h"
 #include "LyraLogChannels.h"
 #include "AbilitySystem/LyraAbilitySystemComponent.h"
+#include "AbilitySystem/LyraAbilityTagRelationshipMapping.h"
 #include "AbilitySystemLog.h"
 #include "Player/LyraPlayerController.h"
 #include "Character/LyraCharacter.h"
@@ -45,6 +46,7 @@ ULyraGameplayAbility::ULyraGameplayAbility(const FObjectInitializer& ObjectIniti
 	ActivationGroup = ELyraAbilityActivationGroup::Independent;
 
 	bLogCancelation = false;
+	bBatchServerRPCs = true;
 
 	ActiveCameraMode = nullptr;
 }
@@ -330,43 +332,8 @@ bool ULyraGameplayAbility::DoesAbilitySatisfyTagRequirements(const UAbilitySyste
 		bBlocked = true;
 	}
 
-	const ULyraAbilitySystemComponent* LyraASC = Cast<ULyraAbilitySystemComponent>(&AbilitySystemComponent);
-	static FGameplayTagContainer AllRequiredTags;
-	static FGameplayTagContainer AllBlockedTags;
-
-	AllRequiredTags = ActivationRequiredTags;
-	AllBlockedTags = ActivationBlockedTags;
-
-	// Expand our ability tags to add additional required/blocked tags
-	if (LyraASC)
-	{
-		LyraASC->GetAdditionalActivationTagRequirements(GetAssetTags(), AllRequiredTags, AllBlockedTags);
-	}
-
 	// Check to see the required/blocked tags for this ability
-	if (AllBlockedTags.Num() || AllRequiredTags.Num())
-	{
-		static FGameplayTagContainer AbilitySystemComponentTags;
-		
-		AbilitySystemComponentTags.Reset();
-		AbilitySystemComponent.GetOwnedGameplayTags(AbilitySystemComponentTags);
-
-		if (AbilitySystemComponentTags.HasAny(AllBlockedTags))
-		{
-			if (OptionalRelevantTags && AbilitySystemComponentTags.HasTag(LyraGameplayTags::Status_Death))
-			{
-				// If player is dead and was rejected due to blocking tags, give that feedback
-				OptionalRelevantTags->AddTag(LyraGameplayTags::Ability_ActivateFail_IsDead);
-			}
-
-			bBlocked = true;
-		}
-
-		if (!AbilitySystemComponentTags.HasAll(AllRequiredTags))
-		{
-			bMissing = true;
-		}
-	}
+	CheckActivationTagRequirements(AbilitySystemComponent, /*out*/ bBlocked, /*out*/ bMissing, OptionalRelevantTags);
 
 	if (SourceTags != nullptr)
 	{
@@ -420,6 +387,54 @@ bool ULyraGameplayAbility::DoesAbilitySatisfyTagRequirements(const UAbilitySyste
 	return true;
 }
 
+void ULyraGameplayAbility::CheckActivationTagRequirements(const UAbilitySystemComponent& AbilitySystemComponent, bool& bOutBlocked, bool& bOutMissing, FGameplayTagContainer* OptionalRelevantTags) const
+{
+	const ULyraAbilitySystemComponent* LyraASC = Cast<ULyraAbilitySystemComponent>(&AbilitySystemComponent);
+	const ULyraAbilityTagRelationshipMapping* Mapping = LyraASC ? LyraASC->GetTagRelationshipMapping() : nullptr;
+	const uint32 MappingGeneration = Mapping ? Mapping->GetCompiledGeneration() : 0;
+
+	FRWScopeLock Lock(EffectiveTagRequirementsLock, SLT_ReadOnly);
+
+	if (!EffectiveTagRequirements.IsUpToDate(Mapping, MappingGeneration))
+	{
+		Lock.ReleaseReadOnlyLockAndAcquireWriteLock_USE_WITH_CAUTION();
+
+		// Someone else may have rebuilt it while we were waiting for the write lock
+		if (!EffectiveTagRequirements.IsUpToDate(Mapping, MappingGeneration))
+		{
+			EffectiveTagRequirements.RequiredTags = ActivationRequiredTags;
+			EffectiveTagRequirements.BlockedTags = ActivationBlockedTags;
+
+			// Expand our ability tags to add additional required/blocked tags
+			if (Mapping)
+			{
+				Mapping->GetRequiredAndBlockedActivationTags(GetAssetTags(), &EffectiveTagRequirements.RequiredTags, &EffectiveTagRequirements.BlockedTags);
+			}
+
+			EffectiveTagRequirements.Mapping = TObjectKey<ULyraAbilityTagRelationshipMapping>(Mapping);
+			EffectiveTagRequirements.MappingGeneration = Mapping ? Mapping->GetCompiledGeneration() : 0;
+			EffectiveTagRequirements.bValid = true;
+		}
+	}
+
+	// Query the ASC's tag count map directly rather than gathering its owned tags into a container
+	if (AbilitySystemComponent.HasAnyMatchingGameplayTags(EffectiveTagRequirements.BlockedTags))
+	{
+		if (OptionalRelevantTags && AbilitySystemComponent.HasMatchingGameplayTag(LyraGameplayTags::Status_Death))
+		{
+			// If player is dead and was rejected due to blocking tags, give that feedback
+			OptionalRelevantTags->AddTag(LyraGameplayTags::Ability_ActivateFail_IsDead);
+		}
+
+		bOutBlocked = true;
+	}
+
+	if (!AbilitySystemComponent.HasAllMatchingGameplayTags(EffectiveTagRequirements.RequiredTags))
+	{
+		bOutMissing = true;
+	}
+}
+
 void ULyraGameplayAbility::OnPawnAvatarSet()
 {
 	K2_OnPawnAvatarSet();
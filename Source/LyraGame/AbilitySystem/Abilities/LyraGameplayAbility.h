@@ -22,6 +22,7 @@ class ILyraAbilitySourceInterface;
 class UAnimMontage;
 class ULyraAbilityCost;
 class ULyraAbilitySystemComponent;
+class ULyraAbilityTagRelationshipMapping;
 class ULyraCameraMode;
 class ULyraHeroComponent;
 class UObject;
@@ -92,6 +93,22 @@ public:
 	TObjectPtr<UAnimMontage> FailureMontage = nullptr;
 };
 
+/** An ability's activation required/blocked tags merged with the tag relationship mapping they were built from */
+struct FLyraAbilityEffectiveTagRequirements
+{
+	FGameplayTagContainer RequiredTags;
+	FGameplayTagContainer BlockedTags;
+
+	TObjectKey<ULyraAbilityTagRelationshipMapping> Mapping;
+	uint32 MappingGeneration = 0;
+	bool bValid = false;
+
+	bool IsUpToDate(const ULyraAbilityTagRelationshipMapping* InMapping, uint32 InMappingGeneration) const
+	{
+		return bValid && (Mapping == TObjectKey<ULyraAbilityTagRelationshipMapping>(InMapping)) && (MappingGeneration == InMappingGeneration);
+	}
+};
+
 /**
  * ULyraGameplayAbility
  *
@@ -124,6 +141,7 @@ public:
 
 	ELyraAbilityActivationPolicy GetActivationPolicy() const { return ActivationPolicy; }
 	ELyraAbilityActivationGroup GetActivationGroup() const { return ActivationGroup; }
+	bool ShouldBatchServerRPCs() const { return bBatchServerRPCs; }
 
 	UE_API void TryActivateAbilityOnSpawn(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec) const;
 
@@ -176,6 +194,9 @@ protected:
 
 	UE_API virtual void GetAbilitySource(FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, float& OutSourceLevel, const ILyraAbilitySourceInterface*& OutAbilitySource, AActor*& OutEffectCauser) const;
 
+	/** Checks the ASC's owned tags against ActivationRequiredTags/ActivationBlockedTags and any extra tags added by the ASC's tag relationship mapping */
+	UE_API void CheckActivationTagRequirements(const UAbilitySystemComponent& AbilitySystemComponent, bool& bOutBlocked, bool& bOutMissing, FGameplayTagContainer* OptionalRelevantTags) const;
+
 	/** Called when this ability is granted to the ability system component. */
 	UFUNCTION(BlueprintImplementableEvent, Category = Ability, DisplayName = "OnAbilityAdded")
 	UE_API void K2_OnAbilityAdded();
@@ -214,8 +235,19 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Advanced")
 	bool bLogCancelation;
 
+	// If true, the activation, target data, and end RPCs sent when this ability is activated from input are batched into a single server RPC.
+	// Disable this for abilities that rely on those RPCs arriving separately.
+	UPROPERTY(EditDefaultsOnly, Category = "Advanced")
+	bool bBatchServerRPCs;
+
 	// Current camera mode set by the ability.
 	TSubclassOf<ULyraCameraMode> ActiveCameraMode;
+
+private:
+
+	// Activation tag requirements merged with the last tag relationship mapping they were checked against (usually only used on the CDO)
+	mutable FLyraAbilityEffectiveTagRequirements EffectiveTagRequirements;
+	mutable FRWLock EffectiveTagRequirementsLock;
 };
 
 #undef UE_API
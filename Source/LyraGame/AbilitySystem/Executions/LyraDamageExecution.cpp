@@ -6,11 +6,42 @@
 #include "AbilitySystem/LyraGameplayEffectContext.h"
 #include "AbilitySystem/LyraAbilitySourceInterface.h"
 #include "Engine/World.h"
+#include "Equipment/LyraEquipmentManagerComponent.h"
+#include "GameFramework/Pawn.h"
 #include "LyraLogChannels.h"
 #include "Teams/LyraTeamSubsystem.h"
+#include "Weapons/LyraRangedWeaponInstance.h"
+#include "Weapons/LyraWeaponFiringStats.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "EngineUtils.h"
+#include "GameplayEffect.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraDamageExecution)
 
+namespace LyraDamageExecutionCVars
+{
+	static bool bUseFrameCache = true;
+	static FAutoConsoleVariableRef CVarUseFrameCache(
+		TEXT("Lyra.Damage.UseFrameCache"),
+		bUseFrameCache,
+		TEXT("Should damage executions share team lookups with the other executions in the same frame?"),
+		ECVF_Default);
+
+#if !UE_BUILD_SHIPPING
+	static FAutoConsoleCommand CmdBenchmarkExecutions(
+		TEXT("Lyra.Damage.BenchmarkExecution"),
+		TEXT("Usage: Lyra.Damage.BenchmarkExecution [NumPellets] [NumTargets] [NumIterations]\nTimes damage executions from the local player against pawns in the world, with and without the per-frame cache."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			const int32 NumPellets = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 12;
+			const int32 NumTargets = (Args.Num() > 1) ? FMath::Max(1, FCString::Atoi(*Args[1])) : 10;
+			const int32 NumIterations = (Args.Num() > 2) ? FMath::Max(1, FCString::Atoi(*Args[2])) : 100;
+			ULyraDamageExecution::BenchmarkExecutions(World, NumPellets, NumTargets, NumIterations, Ar);
+		}));
+#endif
+}
+
 struct FDamageStatics
 {
 	FGameplayEffectAttributeCaptureDefinition BaseDamageDef;
@@ -27,6 +58,56 @@ static FDamageStatics& DamageStatics()
 	return Statics;
 }
 
+// Lookups that come out the same for every execution in a frame (e.g., every pellet of a shotgun blast against each of its targets)
+struct FDamageExecutionFrameCache
+{
+	uint64 FrameNumber = MAX_uint64;
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<ULyraTeamSubsystem> TeamSubsystem;
+	TMap<TPair<FObjectKey, FObjectKey>, bool> CanCauseDamageResults;
+
+	static FDamageExecutionFrameCache& Get(UWorld* InWorld)
+	{
+		check(IsInGameThread());
+
+		FDamageExecutionFrameCache& Cache = Instance();
+		if ((Cache.FrameNumber != GFrameCounter) || (Cache.World.Get() != InWorld))
+		{
+			Cache.FrameNumber = GFrameCounter;
+			Cache.World = InWorld;
+			Cache.TeamSubsystem = InWorld->GetSubsystem<ULyraTeamSubsystem>();
+			Cache.CanCauseDamageResults.Reset();
+		}
+		return Cache;
+	}
+
+	static void Invalidate()
+	{
+		Instance().FrameNumber = MAX_uint64;
+	}
+
+	bool CanCauseDamage(const AActor* EffectCauser, const AActor* HitActor)
+	{
+		const TPair<FObjectKey, FObjectKey> Key(EffectCauser, HitActor);
+		if (const bool* ExistingResult = CanCauseDamageResults.Find(Key))
+		{
+			return *ExistingResult;
+		}
+
+		const ULyraTeamSubsystem* TeamSubsystemPtr = TeamSubsystem.Get();
+		const bool bResult = ensure(TeamSubsystemPtr) && TeamSubsystemPtr->CanCauseDamage(EffectCauser, HitActor);
+		CanCauseDamageResults.Add(Key, bResult);
+		return bResult;
+	}
+
+private:
+	static FDamageExecutionFrameCache& Instance()
+	{
+		static FDamageExecutionFrameCache Cache;
+		return Cache;
+	}
+};
+
 
 ULyraDamageExecution::ULyraDamageExecution()
 {
@@ -36,6 +117,8 @@ ULyraDamageExecution::ULyraDamageExecution()
 void ULyraDamageExecution::Execute_Implementation(const FGameplayEffectCustomExecutionParameters& ExecutionParams, FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const
 {
 #if WITH_SERVER_CODE
+	FLyraWeaponFiringStatScope FiringStatScope(ELyraWeaponFiringStage::DamageExecution);
+
 	const FGameplayEffectSpec& Spec = ExecutionParams.GetOwningSpec();
 	FLyraGameplayEffectContext* TypedContext = FLyraGameplayEffectContext::ExtractEffectContext(Spec.GetContext());
 	check(TypedContext);
@@ -90,10 +173,17 @@ void ULyraDamageExecution::Execute_Implementation(const FGameplayEffectCustomExe
 	float DamageInteractionAllowedMultiplier = 0.0f;
 	if (HitActor)
 	{
-		ULyraTeamSubsystem* TeamSubsystem = HitActor->GetWorld()->GetSubsystem<ULyraTeamSubsystem>();
-		if (ensure(TeamSubsystem))
+		if (LyraDamageExecutionCVars::bUseFrameCache && IsInGameThread())
+		{
+			DamageInteractionAllowedMultiplier = FDamageExecutionFrameCache::Get(HitActor->GetWorld()).CanCauseDamage(EffectCauser, HitActor) ? 1.0 : 0.0;
+		}
+		else
 		{
-			DamageInteractionAllowedMultiplier = TeamSubsystem->CanCauseDamage(EffectCauser, HitActor) ? 1.0 : 0.0;
+			ULyraTeamSubsystem* TeamSubsystem = HitActor->GetWorld()->GetSubsystem<ULyraTeamSubsystem>();
+			if (ensure(TeamSubsystem))
+			{
+				DamageInteractionAllowedMultiplier = TeamSubsystem->CanCauseDamage(EffectCauser, HitActor) ? 1.0 : 0.0;
+			}
 		}
 	}
 
@@ -138,3 +228,117 @@ void ULyraDamageExecution::Execute_Implementation(const FGameplayEffectCustomExe
 #endif // #if WITH_SERVER_CODE
 }
 
+
+#if !UE_BUILD_SHIPPING
+void ULyraDamageExecution::BenchmarkExecutions(UWorld* World, int32 NumPellets, int32 NumTargets, int32 NumIterations, FOutputDevice& Ar)
+{
+#if WITH_SERVER_CODE
+	APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+	APawn* SourcePawn = PC ? PC->GetPawn() : nullptr;
+	UAbilitySystemComponent* SourceASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(SourcePawn);
+	if (SourceASC == nullptr)
+	{
+		Ar.Logf(TEXT("Lyra.Damage.BenchmarkExecution needs a local player pawn with an ability system component"));
+		return;
+	}
+
+	TArray<APawn*> Targets;
+	for (TActorIterator<APawn> PawnIt(World); PawnIt && (Targets.Num() < NumTargets); ++PawnIt)
+	{
+		if ((*PawnIt != SourcePawn) && UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(*PawnIt))
+		{
+			Targets.Add(*PawnIt);
+		}
+	}
+	if (Targets.Num() == 0)
+	{
+		Ar.Logf(TEXT("Lyra.Damage.BenchmarkExecution found no target pawns (try adding some bots)"));
+		return;
+	}
+
+	const ULyraRangedWeaponInstance* Weapon = nullptr;
+	if (ULyraEquipmentManagerComponent* EquipmentManager = SourcePawn->FindComponentByClass<ULyraEquipmentManagerComponent>())
+	{
+		Weapon = EquipmentManager->GetFirstInstanceOfType<ULyraRangedWeaponInstance>();
+	}
+
+	// A transient effect that only runs this execution (the specs and their contexts are built up front, only the executions are timed)
+	UGameplayEffect* DamageEffect = NewObject<UGameplayEffect>(GetTransientPackage(), NAME_None, RF_Transient);
+	FGameplayEffectExecutionDefinition& ExecutionDef = DamageEffect->Executions.AddDefaulted_GetRef();
+	ExecutionDef.CalculationClass = ULyraDamageExecution::StaticClass();
+
+	struct FBenchmarkExecution
+	{
+		TSharedPtr<FGameplayEffectSpec> Spec;
+		UAbilitySystemComponent* TargetASC = nullptr;
+	};
+
+	TArray<FBenchmarkExecution> Executions;
+	for (APawn* Target : Targets)
+	{
+		for (int32 PelletIndex = 0; PelletIndex < NumPellets; ++PelletIndex)
+		{
+			FGameplayEffectContextHandle ContextHandle = SourceASC->MakeEffectContext();
+			FLyraGameplayEffectContext* TypedContext = FLyraGameplayEffectContext::ExtractEffectContext(ContextHandle);
+			check(TypedContext);
+
+			TypedContext->CartridgeID = 1;
+			if (Weapon)
+			{
+				TypedContext->SetAbilitySource(Weapon, 1.0f);
+			}
+
+			FHitResult Hit(Target, nullptr, Target->GetActorLocation(), FVector::UpVector);
+			Hit.TraceStart = SourcePawn->GetActorLocation();
+			Hit.TraceEnd = Target->GetActorLocation();
+			ContextHandle.AddHitResult(Hit);
+
+			FBenchmarkExecution& Execution = Executions.AddDefaulted_GetRef();
+			Execution.Spec = MakeShared<FGameplayEffectSpec>(DamageEffect, ContextHandle, 1.0f);
+			Execution.TargetASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Target);
+		}
+	}
+
+	const ULyraDamageExecution* ExecutionCDO = GetDefault<ULyraDamageExecution>();
+	const TArray<FGameplayEffectExecutionScopedModifierInfo> NoScopedModifiers;
+	const FGameplayTagContainer NoPassedInTags;
+
+	auto RunExecutions = [&](bool bUseFrameCache)
+	{
+		const bool bPreviousUseFrameCache = LyraDamageExecutionCVars::bUseFrameCache;
+		LyraDamageExecutionCVars::bUseFrameCache = bUseFrameCache;
+
+		double TotalSeconds = 0.0;
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			// Each iteration is one shot worth of executions, as if each was on its own frame
+			FDamageExecutionFrameCache::Invalidate();
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (FBenchmarkExecution& Execution : Executions)
+			{
+				FGameplayEffectCustomExecutionParameters Params(*Execution.Spec, NoScopedModifiers, Execution.TargetASC, NoPassedInTags, FPredictionKey());
+				FGameplayEffectCustomExecutionOutput Output;
+				ExecutionCDO->Execute_Implementation(Params, Output);
+			}
+			TotalSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		LyraDamageExecutionCVars::bUseFrameCache = bPreviousUseFrameCache;
+		return TotalSeconds;
+	};
+
+	const double UncachedSeconds = RunExecutions(false);
+	const double CachedSeconds = RunExecutions(true);
+	const int32 TotalExecutions = Executions.Num() * NumIterations;
+
+	Ar.Logf(TEXT("%d pellets x %d targets (%d executions per shot), %d shots%s:"), NumPellets, Targets.Num(), Executions.Num(), NumIterations, Weapon ? TEXT("") : TEXT(" (no ranged weapon equipped, skipping attenuation)"));
+	Ar.Logf(TEXT("  uncached %10.1f executions/ms"), TotalExecutions / FMath::Max(UncachedSeconds * 1000.0, UE_DOUBLE_SMALL_NUMBER));
+	Ar.Logf(TEXT("  cached   %10.1f executions/ms"), TotalExecutions / FMath::Max(CachedSeconds * 1000.0, UE_DOUBLE_SMALL_NUMBER));
+
+	DamageEffect->MarkAsGarbage();
+#else
+	Ar.Logf(TEXT("Lyra.Damage.BenchmarkExecution requires server code"));
+#endif // #if WITH_SERVER_CODE
+}
+#endif
@@ -6,7 +6,9 @@
 
 #include "LyraDamageExecution.generated.h"
 
+class FOutputDevice;
 class UObject;
+class UWorld;
 
 
 /**
@@ -23,6 +25,11 @@ public:
 
 	ULyraDamageExecution();
 
+#if !UE_BUILD_SHIPPING
+	/** Times executions against pawns in the world, as if NumPellets pellets from the local player had hit each of NumTargets targets */
+	static void BenchmarkExecutions(UWorld* World, int32 NumPellets, int32 NumTargets, int32 NumIterations, FOutputDevice& Ar);
+#endif
+
 protected:
 
 	virtual void Execute_Implementation(const FGameplayEffectCustomExecutionParameters& ExecutionParams, FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const override;
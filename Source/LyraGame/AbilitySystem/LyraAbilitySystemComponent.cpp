@@ -16,6 +16,40 @@
 
 UE_DEFINE_GAMEPLAY_TAG(TAG_Gameplay_AbilityInputBlocked, "Gameplay.AbilityInputBlocked");
 
+DECLARE_STATS_GROUP(TEXT("Lyra Ability System"), STATGROUP_LyraAbilitySystem, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Batched Server Ability RPCs"), STAT_LyraBatchedServerAbilityRPCs, STATGROUP_LyraAbilitySystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Server Ability RPCs Saved Per Second"), STAT_LyraServerAbilityRPCsSavedPerSecond, STATGROUP_LyraAbilitySystem);
+
+namespace LyraAbilitySystemComponentCVars
+{
+	static bool bBatchServerAbilityRPCs = true;
+	static FAutoConsoleVariableRef CVarBatchServerAbilityRPCs(
+		TEXT("Lyra.AbilitySystem.BatchServerAbilityRPCs"),
+		bBatchServerAbilityRPCs,
+		TEXT("Should abilities activated from input batch their activation, target data, and end RPCs to the server?"),
+		ECVF_Default);
+}
+
+namespace LyraAbilitySystemComponentStats
+{
+	// RPCs saved by batching, published once a second
+	static int32 ServerAbilityRPCsSaved = 0;
+	static double ServerAbilityRPCsSavedWindowStart = 0.0;
+
+	static void AddServerAbilityRPCsSaved(int32 NumSaved)
+	{
+		ServerAbilityRPCsSaved += NumSaved;
+
+		const double CurrentTime = FPlatformTime::Seconds();
+		if ((CurrentTime - ServerAbilityRPCsSavedWindowStart) >= 1.0)
+		{
+			SET_DWORD_STAT(STAT_LyraServerAbilityRPCsSavedPerSecond, FMath::RoundToInt32(ServerAbilityRPCsSaved / (CurrentTime - ServerAbilityRPCsSavedWindowStart)));
+			ServerAbilityRPCsSaved = 0;
+			ServerAbilityRPCsSavedWindowStart = CurrentTime;
+		}
+	}
+}
+
 ULyraAbilitySystemComponent::ULyraAbilitySystemComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -183,16 +217,102 @@ PRAGMA_ENABLE_DEPRECATION_WARNINGS
 	}
 }
 
+bool ULyraAbilitySystemComponent::ShouldDoServerAbilityRPCBatch() const
+{
+	// Only clients send ability RPCs to the server
+	return LyraAbilitySystemComponentCVars::bBatchServerAbilityRPCs && !IsOwnerActorAuthoritative();
+}
+
+void ULyraAbilitySystemComponent::EndServerAbilityRPCBatch(FGameplayAbilitySpecHandle AbilityHandle)
+{
+	if (const FServerAbilityRPCBatch* Batch = LocalServerAbilityRPCBatchData.FindByPredicate([AbilityHandle](const FServerAbilityRPCBatch& Item) { return Item.AbilitySpecHandle == AbilityHandle; }))
+	{
+		// Without batching each of these would have been a separate RPC
+		const int32 NumRPCs = (Batch->Started ? 1 : 0) + ((Batch->TargetData.Num() > 0) ? 1 : 0) + (Batch->Ended ? 1 : 0);
+		if (NumRPCs > 0)
+		{
+			INC_DWORD_STAT(STAT_LyraBatchedServerAbilityRPCs);
+			LyraAbilitySystemComponentStats::AddServerAbilityRPCsSaved(NumRPCs - 1);
+		}
+	}
+
+	Super::EndServerAbilityRPCBatch(AbilityHandle);
+}
+
+void ULyraAbilitySystemComponent::OnGiveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+	Super::OnGiveAbility(AbilitySpec);
+
+	// Input tags must be added to the spec before it is given (see ULyraAbilitySet::GiveToAbilitySystem)
+	for (const FGameplayTag& Tag : AbilitySpec.GetDynamicSpecSourceTags())
+	{
+		SpecHandlesByInputTag.AddUnique(Tag, AbilitySpec.Handle);
+	}
+
+	const int32 SpecIndex = ActivatableAbilities.Items.IndexOfByPredicate([&AbilitySpec](const FGameplayAbilitySpec& Spec) { return Spec.Handle == AbilitySpec.Handle; });
+	if (SpecIndex != INDEX_NONE)
+	{
+		SpecIndicesByHandle.Add(AbilitySpec.Handle, SpecIndex);
+	}
+}
+
+void ULyraAbilitySystemComponent::OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+	for (const FGameplayTag& Tag : AbilitySpec.GetDynamicSpecSourceTags())
+	{
+		SpecHandlesByInputTag.Remove(Tag, AbilitySpec.Handle);
+	}
+
+	// Removing the spec can move other specs around, so the indices are rebuilt on the next lookup
+	SpecIndicesByHandle.Reset();
+
+	// Pressed/released handles are cleared at the end of the frame (and may be being iterated right now), but held ones would otherwise linger
+	InputHeldSpecHandles.Remove(AbilitySpec.Handle);
+
+	Super::OnRemoveAbility(AbilitySpec);
+}
+
+FGameplayAbilitySpec* ULyraAbilitySystemComponent::FindIndexedAbilitySpecFromHandle(FGameplayAbilitySpecHandle Handle)
+{
+	TArray<FGameplayAbilitySpec>& Items = ActivatableAbilities.Items;
+
+	if (const int32* SpecIndex = SpecIndicesByHandle.Find(Handle))
+	{
+		if (Items.IsValidIndex(*SpecIndex) && (Items[*SpecIndex].Handle == Handle))
+		{
+			return &Items[*SpecIndex];
+		}
+	}
+
+	SpecIndicesByHandle.Reset();
+	SpecIndicesByHandle.Reserve(Items.Num());
+
+	FGameplayAbilitySpec* FoundSpec = nullptr;
+	for (int32 SpecIndex = 0; SpecIndex < Items.Num(); ++SpecIndex)
+	{
+		SpecIndicesByHandle.Add(Items[SpecIndex].Handle, SpecIndex);
+
+		if (Items[SpecIndex].Handle == Handle)
+		{
+			FoundSpec = &Items[SpecIndex];
+		}
+	}
+
+	return FoundSpec;
+}
+
 void ULyraAbilitySystemComponent::AbilityInputTagPressed(const FGameplayTag& InputTag)
 {
 	if (InputTag.IsValid())
 	{
-		for (const FGameplayAbilitySpec& AbilitySpec : ActivatableAbilities.Items)
+		for (auto It = SpecHandlesByInputTag.CreateConstKeyIterator(InputTag); It; ++It)
 		{
-			if (AbilitySpec.Ability && (AbilitySpec.GetDynamicSpecSourceTags().HasTagExact(InputTag)))
+			const FGameplayAbilitySpecHandle& SpecHandle = It.Value();
+			const FGameplayAbilitySpec* AbilitySpec = FindIndexedAbilitySpecFromHandle(SpecHandle);
+			if (AbilitySpec && AbilitySpec->Ability && (AbilitySpec->GetDynamicSpecSourceTags().HasTagExact(InputTag)))
 			{
-				InputPressedSpecHandles.AddUnique(AbilitySpec.Handle);
-				InputHeldSpecHandles.AddUnique(AbilitySpec.Handle);
+				InputPressedSpecHandles.AddUnique(SpecHandle);
+				InputHeldSpecHandles.AddUnique(SpecHandle);
 			}
 		}
 	}
@@ -202,12 +322,14 @@ void ULyraAbilitySystemComponent::AbilityInputTagReleased(const FGameplayTag& In
 {
 	if (InputTag.IsValid())
 	{
-		for (const FGameplayAbilitySpec& AbilitySpec : ActivatableAbilities.Items)
+		for (auto It = SpecHandlesByInputTag.CreateConstKeyIterator(InputTag); It; ++It)
 		{
-			if (AbilitySpec.Ability && (AbilitySpec.GetDynamicSpecSourceTags().HasTagExact(InputTag)))
+			const FGameplayAbilitySpecHandle& SpecHandle = It.Value();
+			const FGameplayAbilitySpec* AbilitySpec = FindIndexedAbilitySpecFromHandle(SpecHandle);
+			if (AbilitySpec && AbilitySpec->Ability && (AbilitySpec->GetDynamicSpecSourceTags().HasTagExact(InputTag)))
 			{
-				InputReleasedSpecHandles.AddUnique(AbilitySpec.Handle);
-				InputHeldSpecHandles.Remove(AbilitySpec.Handle);
+				InputReleasedSpecHandles.AddUnique(SpecHandle);
+				InputHeldSpecHandles.Remove(SpecHandle);
 			}
 		}
 	}
@@ -221,17 +343,14 @@ void ULyraAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGam
 		return;
 	}
 
-	static TArray<FGameplayAbilitySpecHandle> AbilitiesToActivate;
-	AbilitiesToActivate.Reset();
-
-	//@TODO: See if we can use FScopedServerAbilityRPCBatcher ScopedRPCBatcher in some of these loops
+	TArray<FGameplayAbilitySpecHandle, TInlineAllocator<8>> AbilitiesToActivate;
 
 	//
 	// Process all abilities that activate when the input is held.
 	//
 	for (const FGameplayAbilitySpecHandle& SpecHandle : InputHeldSpecHandles)
 	{
-		if (const FGameplayAbilitySpec* AbilitySpec = FindAbilitySpecFromHandle(SpecHandle))
+		if (const FGameplayAbilitySpec* AbilitySpec = FindIndexedAbilitySpecFromHandle(SpecHandle))
 		{
 			if (AbilitySpec->Ability && !AbilitySpec->IsActive())
 			{
@@ -249,7 +368,7 @@ void ULyraAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGam
 	//
 	for (const FGameplayAbilitySpecHandle& SpecHandle : InputPressedSpecHandles)
 	{
-		if (FGameplayAbilitySpec* AbilitySpec = FindAbilitySpecFromHandle(SpecHandle))
+		if (FGameplayAbilitySpec* AbilitySpec = FindIndexedAbilitySpecFromHandle(SpecHandle))
 		{
 			if (AbilitySpec->Ability)
 			{
@@ -278,9 +397,22 @@ void ULyraAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGam
 	// We do it all at once so that held inputs don't activate the ability
 	// and then also send a input event to the ability because of the press.
 	//
+	// Abilities that activate, send their target data, and end within the activation (e.g., hitscan weapons) send all of that to the server in a single RPC.
+	//
 	for (const FGameplayAbilitySpecHandle& AbilitySpecHandle : AbilitiesToActivate)
 	{
-		TryActivateAbility(AbilitySpecHandle);
+		const FGameplayAbilitySpec* AbilitySpec = FindIndexedAbilitySpecFromHandle(AbilitySpecHandle);
+		const ULyraGameplayAbility* LyraAbilityCDO = AbilitySpec ? Cast<ULyraGameplayAbility>(AbilitySpec->Ability) : nullptr;
+
+		if (LyraAbilityCDO && LyraAbilityCDO->ShouldBatchServerRPCs())
+		{
+			FScopedServerAbilityRPCBatcher ScopedRPCBatcher(this, AbilitySpecHandle);
+			TryActivateAbility(AbilitySpecHandle);
+		}
+		else
+		{
+			TryActivateAbility(AbilitySpecHandle);
+		}
 	}
 
 	//
@@ -288,7 +420,7 @@ void ULyraAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGam
 	//
 	for (const FGameplayAbilitySpecHandle& SpecHandle : InputReleasedSpecHandles)
 	{
-		if (FGameplayAbilitySpec* AbilitySpec = FindAbilitySpecFromHandle(SpecHandle))
+		if (FGameplayAbilitySpec* AbilitySpec = FindIndexedAbilitySpecFromHandle(SpecHandle))
 		{
 			if (AbilitySpec->Ability)
 			{
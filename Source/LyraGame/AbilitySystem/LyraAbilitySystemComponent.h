@@ -66,6 +66,9 @@ public:
 
 	/** Sets the current tag relationship mapping, if null it will clear it out */
 	UE_API void SetTagRelationshipMapping(ULyraAbilityTagRelationshipMapping* NewMapping);
+
+	/** Returns the current tag relationship mapping, if any */
+	const ULyraAbilityTagRelationshipMapping* GetTagRelationshipMapping() const { return TagRelationshipMapping; }
 	
 	/** Looks at ability tags and gathers additional required and blocking tags */
 	UE_API void GetAdditionalActivationTagRequirements(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer& OutActivationRequired, FGameplayTagContainer& OutActivationBlocked) const;
@@ -77,6 +80,15 @@ protected:
 	UE_API virtual void AbilitySpecInputPressed(FGameplayAbilitySpec& Spec) override;
 	UE_API virtual void AbilitySpecInputReleased(FGameplayAbilitySpec& Spec) override;
 
+	UE_API virtual bool ShouldDoServerAbilityRPCBatch() const override;
+	UE_API virtual void EndServerAbilityRPCBatch(FGameplayAbilitySpecHandle AbilityHandle) override;
+
+	UE_API virtual void OnGiveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+	UE_API virtual void OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+
+	// Finds the spec for a handle using the cached spec indices, falling back to (and rebuilding them from) a full search
+	UE_API FGameplayAbilitySpec* FindIndexedAbilitySpecFromHandle(FGameplayAbilitySpecHandle Handle);
+
 	UE_API virtual void NotifyAbilityActivated(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability) override;
 	UE_API virtual void NotifyAbilityFailed(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason) override;
 	UE_API virtual void NotifyAbilityEnded(FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, bool bWasCancelled) override;
@@ -103,6 +115,12 @@ protected:
 	// Handles to abilities that have their input held.
 	TArray<FGameplayAbilitySpecHandle> InputHeldSpecHandles;
 
+	// Handles to abilities for each of their dynamic spec source tags (which is where input tags are added), kept up to date as abilities are given and removed.
+	TMultiMap<FGameplayTag, FGameplayAbilitySpecHandle> SpecHandlesByInputTag;
+
+	// Index into ActivatableAbilities.Items for each ability handle, validated on use since the items can be reordered.
+	TMap<FGameplayAbilitySpecHandle, int32> SpecIndicesByHandle;
+
 	// Number of abilities running in each activation group.
 	int32 ActivationGroupCounts[(uint8)ELyraAbilityActivationGroup::MAX];
 };
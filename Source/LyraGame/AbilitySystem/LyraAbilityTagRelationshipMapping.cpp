@@ -2,52 +2,197 @@
 
 #include "AbilitySystem/LyraAbilityTagRelationshipMapping.h"
 
+#include "GameplayTagsManager.h"
+#include "HAL/IConsoleManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraAbilityTagRelationshipMapping)
 
-void ULyraAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const
+#if !UE_BUILD_SHIPPING
+namespace LyraAbilityTagRelationshipMappingCVars
+{
+	static FAutoConsoleCommand CmdBenchmarkTagRelationships(
+		TEXT("Lyra.AbilitySystem.BenchmarkTagRelationships"),
+		TEXT("Usage: Lyra.AbilitySystem.BenchmarkTagRelationships [NumEntries] [NumIterations]\nTimes the compiled ability tag relationship lookups against iterating every relationship."),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+		{
+			const int32 NumEntries = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+			const int32 NumIterations = (Args.Num() > 1) ? FMath::Max(1, FCString::Atoi(*Args[1])) : 10000;
+			ULyraAbilityTagRelationshipMapping::BenchmarkCompiledRelationships(NumEntries, NumIterations, Ar);
+		}));
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////
+
+ULyraAbilityTagRelationshipMapping::FAbilityTagsKey::FAbilityTagsKey(const FGameplayTagContainer& InTags)
+	: Tags(InTags)
 {
-	// Simple iteration for now
+	// Order independent, so the same tags in a different order share a cache entry
+	for (const FGameplayTag& Tag : Tags)
+	{
+		Hash += GetTypeHash(Tag);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void ULyraAbilityTagRelationshipMapping::PostLoad()
+{
+	Super::PostLoad();
+
+	CompileRelationships();
+}
+
+#if WITH_EDITOR
+void ULyraAbilityTagRelationshipMapping::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	CompileRelationships();
+}
+#endif
+
+void ULyraAbilityTagRelationshipMapping::EnsureCompiled() const
+{
+	if (!bCompiled)
+	{
+		CompileRelationships();
+	}
+}
+
+void ULyraAbilityTagRelationshipMapping::CompileRelationships() const
+{
+	FRWScopeLock WriteLock(ResultsLock, SLT_Write);
+
+	RelationshipsByAbilityTag.Reset();
+	CancelTagsByAbilityTag.Reset();
+	ResultsByAbilityTags.Reset();
+
 	for (int32 i = 0; i < AbilityTagRelationships.Num(); i++)
 	{
 		const FLyraAbilityTagRelationship& Tags = AbilityTagRelationships[i];
-		if (AbilityTags.HasTag(Tags.AbilityTag))
+		if (Tags.AbilityTag.IsValid())
 		{
-			if (OutTagsToBlock)
-			{
-				OutTagsToBlock->AppendTags(Tags.AbilityTagsToBlock);
-			}
-			if (OutTagsToCancel)
-			{
-				OutTagsToCancel->AppendTags(Tags.AbilityTagsToCancel);
-			}
+			RelationshipsByAbilityTag.FindOrAdd(Tags.AbilityTag).Add(i);
+			CancelTagsByAbilityTag.FindOrAdd(Tags.AbilityTag).AppendTags(Tags.AbilityTagsToCancel);
 		}
 	}
+
+	++CompiledGeneration;
+	bCompiled = true;
+}
+
+void ULyraAbilityTagRelationshipMapping::BuildRelationshipsForAbilityTags(const FGameplayTagContainer& AbilityTags, FLyraAbilityTagRelationshipResult& OutResult) const
+{
+	// A relationship applies if the ability has its tag or any child of it, so expand the ability tags to include all of their parents
+	const FGameplayTagContainer ExpandedAbilityTags = AbilityTags.GetGameplayTagParents();
+
+	// Visit the relationships in asset order, as the uncompiled version did
+	TArray<int32, TInlineAllocator<16>> MatchingIndices;
+	for (const FGameplayTag& AbilityTag : ExpandedAbilityTags)
+	{
+		if (const TArray<int32, TInlineAllocator<2>>* Indices = RelationshipsByAbilityTag.Find(AbilityTag))
+		{
+			MatchingIndices.Append(*Indices);
+		}
+	}
+	MatchingIndices.Sort();
+
+	for (const int32 Index : MatchingIndices)
+	{
+		const FLyraAbilityTagRelationship& Tags = AbilityTagRelationships[Index];
+		OutResult.TagsToBlock.AppendTags(Tags.AbilityTagsToBlock);
+		OutResult.TagsToCancel.AppendTags(Tags.AbilityTagsToCancel);
+		OutResult.ActivationRequired.AppendTags(Tags.ActivationRequiredTags);
+		OutResult.ActivationBlocked.AppendTags(Tags.ActivationBlockedTags);
+	}
+}
+
+const FLyraAbilityTagRelationshipResult& ULyraAbilityTagRelationshipMapping::GetRelationshipsForAbilityTags(const FGameplayTagContainer& AbilityTags) const
+{
+	EnsureCompiled();
+
+	const FAbilityTagsKey Key(AbilityTags);
+
+	{
+		FRWScopeLock ReadLock(ResultsLock, SLT_ReadOnly);
+		if (const TUniquePtr<FLyraAbilityTagRelationshipResult>* ExistingResult = ResultsByAbilityTags.Find(Key))
+		{
+			return **ExistingResult;
+		}
+	}
+
+	TUniquePtr<FLyraAbilityTagRelationshipResult> NewResult = MakeUnique<FLyraAbilityTagRelationshipResult>();
+	BuildRelationshipsForAbilityTags(AbilityTags, *NewResult);
+
+	FRWScopeLock WriteLock(ResultsLock, SLT_Write);
+
+	// Another thread may have beaten us to it
+	TUniquePtr<FLyraAbilityTagRelationshipResult>& Result = ResultsByAbilityTags.FindOrAdd(Key);
+	if (!Result.IsValid())
+	{
+		Result = MoveTemp(NewResult);
+	}
+	return *Result;
+}
+
+void ULyraAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const
+{
+	const FLyraAbilityTagRelationshipResult& Result = GetRelationshipsForAbilityTags(AbilityTags);
+	if (OutTagsToBlock)
+	{
+		OutTagsToBlock->AppendTags(Result.TagsToBlock);
+	}
+	if (OutTagsToCancel)
+	{
+		OutTagsToCancel->AppendTags(Result.TagsToCancel);
+	}
 }
 
 void ULyraAbilityTagRelationshipMapping::GetRequiredAndBlockedActivationTags(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutActivationRequired, FGameplayTagContainer* OutActivationBlocked) const
 {
-	// Simple iteration for now
+	const FLyraAbilityTagRelationshipResult& Result = GetRelationshipsForAbilityTags(AbilityTags);
+	if (OutActivationRequired)
+	{
+		OutActivationRequired->AppendTags(Result.ActivationRequired);
+	}
+	if (OutActivationBlocked)
+	{
+		OutActivationBlocked->AppendTags(Result.ActivationBlocked);
+	}
+}
+
+bool ULyraAbilityTagRelationshipMapping::IsAbilityCancelledByTag(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const
+{
+	EnsureCompiled();
+
+	// The union of the cancel tags for every relationship on this exact tag has any of the ability tags iff one of them does
+	const FGameplayTagContainer* CancelTags = CancelTagsByAbilityTag.Find(ActionTag);
+	return (CancelTags != nullptr) && CancelTags->HasAny(AbilityTags);
+}
+
+#if !UE_BUILD_SHIPPING
+void ULyraAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel_Uncompiled(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const
+{
 	for (int32 i = 0; i < AbilityTagRelationships.Num(); i++)
 	{
 		const FLyraAbilityTagRelationship& Tags = AbilityTagRelationships[i];
 		if (AbilityTags.HasTag(Tags.AbilityTag))
 		{
-			if (OutActivationRequired)
+			if (OutTagsToBlock)
 			{
-				OutActivationRequired->AppendTags(Tags.ActivationRequiredTags);
+				OutTagsToBlock->AppendTags(Tags.AbilityTagsToBlock);
 			}
-			if (OutActivationBlocked)
+			if (OutTagsToCancel)
 			{
-				OutActivationBlocked->AppendTags(Tags.ActivationBlockedTags);
+				OutTagsToCancel->AppendTags(Tags.AbilityTagsToCancel);
 			}
 		}
 	}
 }
 
-bool ULyraAbilityTagRelationshipMapping::IsAbilityCancelledByTag(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const
+bool ULyraAbilityTagRelationshipMapping::IsAbilityCancelledByTag_Uncompiled(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const
 {
-	// Simple iteration for now
 	for (int32 i = 0; i < AbilityTagRelationships.Num(); i++)
 	{
 		const FLyraAbilityTagRelationship& Tags = AbilityTagRelationships[i];
@@ -61,3 +206,90 @@ bool ULyraAbilityTagRelationshipMapping::IsAbilityCancelledByTag(const FGameplay
 	return false;
 }
 
+void ULyraAbilityTagRelationshipMapping::BenchmarkCompiledRelationships(int32 NumEntries, int32 NumIterations, FOutputDevice& Ar)
+{
+	FGameplayTagContainer AllTags;
+	UGameplayTagsManager::Get().RequestAllGameplayTags(/*out*/ AllTags, /*OnlyIncludeDictionaryTags=*/ false);
+
+	TArray<FGameplayTag> TagPool;
+	AllTags.GetGameplayTagArray(/*out*/ TagPool);
+	if (TagPool.Num() < 2)
+	{
+		Ar.Logf(TEXT("Not enough gameplay tags registered to build a benchmark mapping"));
+		return;
+	}
+
+	FRandomStream RandomStream(NumEntries);
+	auto RandomTag = [&]() { return TagPool[RandomStream.RandHelper(TagPool.Num())]; };
+	auto RandomContainer = [&](int32 NumTags)
+	{
+		FGameplayTagContainer Result;
+		for (int32 i = 0; i < NumTags; ++i)
+		{
+			Result.AddTag(RandomTag());
+		}
+		return Result;
+	};
+
+	ULyraAbilityTagRelationshipMapping* Mapping = NewObject<ULyraAbilityTagRelationshipMapping>(GetTransientPackage());
+	for (int32 i = 0; i < NumEntries; ++i)
+	{
+		FLyraAbilityTagRelationship& Relationship = Mapping->AbilityTagRelationships.AddDefaulted_GetRef();
+		Relationship.AbilityTag = RandomTag();
+		Relationship.AbilityTagsToBlock = RandomContainer(3);
+		Relationship.AbilityTagsToCancel = RandomContainer(3);
+		Relationship.ActivationRequiredTags = RandomContainer(1);
+		Relationship.ActivationBlockedTags = RandomContainer(2);
+	}
+	Mapping->CompileRelationships();
+
+	// A handful of distinct abilities, queried over and over like activation checks would
+	TArray<FGameplayTagContainer> AbilityTagSets;
+	for (int32 i = 0; i < 16; ++i)
+	{
+		AbilityTagSets.Add(RandomContainer(2));
+	}
+
+	int32 Mismatches = 0;
+	for (const FGameplayTagContainer& AbilityTags : AbilityTagSets)
+	{
+		FGameplayTagContainer UncompiledBlock, UncompiledCancel, CompiledBlock, CompiledCancel;
+		Mapping->GetAbilityTagsToBlockAndCancel_Uncompiled(AbilityTags, &UncompiledBlock, &UncompiledCancel);
+		Mapping->GetAbilityTagsToBlockAndCancel(AbilityTags, &CompiledBlock, &CompiledCancel);
+		if ((UncompiledBlock.Num() != CompiledBlock.Num()) || !UncompiledBlock.HasAllExact(CompiledBlock) ||
+			(UncompiledCancel.Num() != CompiledCancel.Num()) || !UncompiledCancel.HasAllExact(CompiledCancel))
+		{
+			++Mismatches;
+		}
+	}
+
+	int32 Checksum = 0;
+
+	const double UncompiledStartTime = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		const FGameplayTagContainer& AbilityTags = AbilityTagSets[Iteration % AbilityTagSets.Num()];
+		FGameplayTagContainer TagsToBlock, TagsToCancel;
+		Mapping->GetAbilityTagsToBlockAndCancel_Uncompiled(AbilityTags, &TagsToBlock, &TagsToCancel);
+		Checksum += TagsToBlock.Num() + (Mapping->IsAbilityCancelledByTag_Uncompiled(AbilityTags, AbilityTagSets[0].First()) ? 1 : 0);
+	}
+	const double UncompiledSeconds = FPlatformTime::Seconds() - UncompiledStartTime;
+
+	const double CompiledStartTime = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		const FGameplayTagContainer& AbilityTags = AbilityTagSets[Iteration % AbilityTagSets.Num()];
+		FGameplayTagContainer TagsToBlock, TagsToCancel;
+		Mapping->GetAbilityTagsToBlockAndCancel(AbilityTags, &TagsToBlock, &TagsToCancel);
+		Checksum -= TagsToBlock.Num() + (Mapping->IsAbilityCancelledByTag(AbilityTags, AbilityTagSets[0].First()) ? 1 : 0);
+	}
+	const double CompiledSeconds = FPlatformTime::Seconds() - CompiledStartTime;
+
+	Ar.Logf(TEXT("Tag relationship mapping with %d entries, %d queries:"), NumEntries, NumIterations);
+	Ar.Logf(TEXT("  uncompiled %8.3f us/query"), (UncompiledSeconds * 1.0e6) / NumIterations);
+	Ar.Logf(TEXT("  compiled   %8.3f us/query"), (CompiledSeconds * 1.0e6) / NumIterations);
+	Ar.Logf(TEXT("  %d mismatched results, checksum delta %d"), Mismatches, Checksum);
+
+	Mapping->MarkAsGarbage();
+}
+#endif
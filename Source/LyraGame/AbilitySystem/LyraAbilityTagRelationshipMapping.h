@@ -37,6 +37,15 @@ struct FLyraAbilityTagRelationship
 };
 
 
+/** The merged result of every relationship that applies to a given set of ability tags */
+struct FLyraAbilityTagRelationshipResult
+{
+	FGameplayTagContainer TagsToBlock;
+	FGameplayTagContainer TagsToCancel;
+	FGameplayTagContainer ActivationRequired;
+	FGameplayTagContainer ActivationBlocked;
+};
+
 /** Mapping of how ability tags block or cancel other abilities */
 UCLASS()
 class ULyraAbilityTagRelationshipMapping : public UDataAsset
@@ -49,6 +58,13 @@ private:
 	TArray<FLyraAbilityTagRelationship> AbilityTagRelationships;
 
 public:
+	//~UObject interface
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~End of UObject interface
+
 	/** Given a set of ability tags, parse the tag relationship and fill out tags to block and cancel */
 	void GetAbilityTagsToBlockAndCancel(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const;
 
@@ -57,4 +73,65 @@ public:
 
 	/** Returns true if the specified ability tags are canceled by the passed in action tag */
 	bool IsAbilityCancelledByTag(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const;
+
+	/**
+	 * Returns every relationship that applies to the specified ability tags merged together (computed once per distinct set of tags).
+	 * The result stays valid until the mapping is recompiled (see GetCompiledGeneration).
+	 */
+	const FLyraAbilityTagRelationshipResult& GetRelationshipsForAbilityTags(const FGameplayTagContainer& AbilityTags) const;
+
+	/** Returns a counter that changes every time the relationships are recompiled (e.g., after an edit) */
+	uint32 GetCompiledGeneration() const
+	{
+		return CompiledGeneration;
+	}
+
+#if !UE_BUILD_SHIPPING
+	/** Compares the compiled lookups against iterating the relationships directly, using a transient mapping with NumEntries relationships */
+	static void BenchmarkCompiledRelationships(int32 NumEntries, int32 NumIterations, FOutputDevice& Ar);
+#endif
+
+private:
+	/** Key for the per ability-tag-container cache, compares the tags independent of order */
+	struct FAbilityTagsKey
+	{
+		FGameplayTagContainer Tags;
+		uint32 Hash = 0;
+
+		explicit FAbilityTagsKey(const FGameplayTagContainer& InTags);
+
+		bool operator==(const FAbilityTagsKey& Other) const
+		{
+			return (Hash == Other.Hash) && (Tags.Num() == Other.Tags.Num()) && Tags.HasAllExact(Other.Tags);
+		}
+
+		friend uint32 GetTypeHash(const FAbilityTagsKey& Key)
+		{
+			return Key.Hash;
+		}
+	};
+
+	void CompileRelationships() const;
+	void EnsureCompiled() const;
+	void BuildRelationshipsForAbilityTags(const FGameplayTagContainer& AbilityTags, FLyraAbilityTagRelationshipResult& OutResult) const;
+
+#if !UE_BUILD_SHIPPING
+	// The original uncompiled lookups, kept for benchmarking and validation
+	void GetAbilityTagsToBlockAndCancel_Uncompiled(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const;
+	bool IsAbilityCancelledByTag_Uncompiled(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const;
+#endif
+
+private:
+	/** Indices into AbilityTagRelationships for each (exact) AbilityTag */
+	mutable TMap<FGameplayTag, TArray<int32, TInlineAllocator<2>>> RelationshipsByAbilityTag;
+
+	/** The merged AbilityTagsToCancel of every relationship for each (exact) AbilityTag */
+	mutable TMap<FGameplayTag, FGameplayTagContainer> CancelTagsByAbilityTag;
+
+	/** Merged results for each distinct set of ability tags that has been queried */
+	mutable TMap<FAbilityTagsKey, TUniquePtr<FLyraAbilityTagRelationshipResult>> ResultsByAbilityTags;
+	mutable FRWLock ResultsLock;
+
+	mutable uint32 CompiledGeneration = 0;
+	mutable bool bCompiled = false;
 };
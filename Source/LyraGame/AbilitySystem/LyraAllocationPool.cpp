@@ -0,0 +1,253 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "LyraAllocationPool.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "Stats/Stats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Allocations"), STAT_LyraPooledAllocations, STATGROUP_Game);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live Pooled Objects"), STAT_LyraLivePooledObjects, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Allocation Misses"), STAT_LyraPooledAllocationMisses, STATGROUP_Game);
+
+namespace LyraAllocationPoolCVars
+{
+	static int32 MaxFreeBlocksPerPool = 1024;
+	static FAutoConsoleVariableRef CVarMaxFreeBlocksPerPool(
+		TEXT("Lyra.AllocationPool.MaxFreeBlocks"),
+		MaxFreeBlocksPerPool,
+		TEXT("Maximum number of released blocks each allocation pool keeps for reuse (0 disables pooling)"),
+		ECVF_Default);
+
+#if !UE_BUILD_SHIPPING
+	static FAutoConsoleCommandWithArgsAndOutputDevice CmdBenchmarkAllocationPool(
+		TEXT("Lyra.AllocationPool.Benchmark"),
+		TEXT("Usage: Lyra.AllocationPool.Benchmark [NumIterations] [BatchSize] [NumThreads]\nTimes allocating and freeing effect context sized blocks through an allocation pool against FMemory."),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+		{
+			const int32 NumIterations = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+			const int32 BatchSize = (Args.Num() > 1) ? FMath::Max(1, FCString::Atoi(*Args[1])) : 32;
+			const int32 NumThreads = (Args.Num() > 2) ? FMath::Max(1, FCString::Atoi(*Args[2])) : 4;
+			FLyraAllocationPool::BenchmarkAgainstMalloc(NumIterations, BatchSize, NumThreads, Ar);
+		}));
+#endif
+}
+
+namespace LyraAllocationPool
+{
+	static FCriticalSection AllPoolsLock;
+	static FLyraAllocationPool* FirstPool = nullptr;
+	static FLyraLiveObjectCounter* FirstCounter = nullptr;
+}
+
+FLyraLiveObjectCounter::FLyraLiveObjectCounter(const TCHAR* InName)
+	: Name(InName)
+{
+	FScopeLock Lock(&LyraAllocationPool::AllPoolsLock);
+	NextCounter = LyraAllocationPool::FirstCounter;
+	LyraAllocationPool::FirstCounter = this;
+}
+
+void FLyraLiveObjectCounter::Increment()
+{
+	const int32 NewNumLive = ++NumLive;
+	int32 OldPeakLive = PeakLive.load(std::memory_order_relaxed);
+	while ((NewNumLive > OldPeakLive) && !PeakLive.compare_exchange_weak(OldPeakLive, NewNumLive, std::memory_order_relaxed))
+	{
+	}
+	INC_DWORD_STAT(STAT_LyraLivePooledObjects);
+}
+
+void FLyraLiveObjectCounter::Decrement()
+{
+	--NumLive;
+	DEC_DWORD_STAT(STAT_LyraLivePooledObjects);
+}
+
+void FLyraLiveObjectCounter::DumpAllCounters(FOutputDevice& Ar)
+{
+	FScopeLock Lock(&LyraAllocationPool::AllPoolsLock);
+	for (FLyraLiveObjectCounter* Counter = LyraAllocationPool::FirstCounter; Counter != nullptr; Counter = Counter->NextCounter)
+	{
+		Ar.Logf(TEXT("%s: %d live (peak %d)"), Counter->Name, Counter->NumLive.load(), Counter->PeakLive.load());
+	}
+}
+
+FLyraAllocationPool::FLyraAllocationPool(const TCHAR* InName, SIZE_T InBlockSize, uint32 InBlockAlignment)
+	: Name(InName)
+	, BlockSize(InBlockSize)
+	, BlockAlignment(InBlockAlignment)
+{
+	FScopeLock Lock(&LyraAllocationPool::AllPoolsLock);
+	NextPool = LyraAllocationPool::FirstPool;
+	LyraAllocationPool::FirstPool = this;
+}
+
+void* FLyraAllocationPool::Allocate(SIZE_T Size)
+{
+	if (Size != BlockSize)
+	{
+		return FMemory::Malloc(Size, BlockAlignment);
+	}
+
+	void* Block = nullptr;
+	{
+		FScopeLock Lock(&FreeBlocksLock);
+		if (FreeBlocks.Num() > 0)
+		{
+			Block = FreeBlocks.Pop(EAllowShrinking::No);
+		}
+	}
+
+	if (Block != nullptr)
+	{
+		++NumHits;
+	}
+	else
+	{
+		++NumMisses;
+		INC_DWORD_STAT(STAT_LyraPooledAllocationMisses);
+		Block = FMemory::Malloc(BlockSize, BlockAlignment);
+	}
+
+	INC_DWORD_STAT(STAT_LyraPooledAllocations);
+
+	return Block;
+}
+
+void FLyraAllocationPool::Free(void* Ptr, SIZE_T Size)
+{
+	if (Ptr == nullptr)
+	{
+		return;
+	}
+
+	if (Size != BlockSize)
+	{
+		FMemory::Free(Ptr);
+		return;
+	}
+
+	// Not necessarily one of ours (see the class comment), so this is only counted as a release
+	++NumReleases;
+
+	{
+		FScopeLock Lock(&FreeBlocksLock);
+		if (FreeBlocks.Num() < LyraAllocationPoolCVars::MaxFreeBlocksPerPool)
+		{
+			FreeBlocks.Add(Ptr);
+			return;
+		}
+	}
+
+	FMemory::Free(Ptr);
+}
+
+void FLyraAllocationPool::DumpAllPools(FOutputDevice& Ar)
+{
+	FScopeLock Lock(&LyraAllocationPool::AllPoolsLock);
+	for (FLyraAllocationPool* Pool = LyraAllocationPool::FirstPool; Pool != nullptr; Pool = Pool->NextPool)
+	{
+		int32 NumFree = 0;
+		{
+			FScopeLock FreeLock(&Pool->FreeBlocksLock);
+			NumFree = Pool->FreeBlocks.Num();
+		}
+
+		const uint64 Hits = Pool->NumHits.load();
+		const uint64 Misses = Pool->NumMisses.load();
+		const uint64 Releases = Pool->NumReleases.load();
+		const double HitRate = ((Hits + Misses) > 0) ? (100.0 * (double)Hits / (double)(Hits + Misses)) : 0.0;
+
+		Ar.Logf(TEXT("%s (%d bytes): %llu allocations (%llu hits, %llu misses, %.1f%% hit rate), %llu releases, %d free"),
+			Pool->Name, (int32)Pool->BlockSize, Hits + Misses, Hits, Misses, HitRate, Releases, NumFree);
+	}
+}
+
+static void DumpAllocationPoolsAndCounters(FOutputDevice& Ar)
+{
+	FLyraAllocationPool::DumpAllPools(Ar);
+	FLyraLiveObjectCounter::DumpAllCounters(Ar);
+}
+
+#if !UE_BUILD_SHIPPING
+void FLyraAllocationPool::BenchmarkAgainstMalloc(int32 NumIterations, int32 BatchSize, int32 NumThreads, FOutputDevice& Ar)
+{
+	// Roughly the size of FLyraGameplayEffectContext; never destroyed for the same reason as the type pools
+	constexpr SIZE_T BenchmarkBlockSize = 192;
+	constexpr uint32 BenchmarkBlockAlignment = 16;
+	static FLyraAllocationPool& BenchmarkPool = *new FLyraAllocationPool(TEXT("Benchmark"), BenchmarkBlockSize, BenchmarkBlockAlignment);
+
+	if (BatchSize > LyraAllocationPoolCVars::MaxFreeBlocksPerPool)
+	{
+		Ar.Logf(TEXT("Warning: BatchSize %d is above Lyra.AllocationPool.MaxFreeBlocks (%d), the pool can't recycle every block"), BatchSize, LyraAllocationPoolCVars::MaxFreeBlocksPerPool);
+	}
+
+	auto RunPool = [&]()
+	{
+		TArray<void*> Blocks;
+		Blocks.SetNumUninitialized(BatchSize);
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (int32 Index = 0; Index < BatchSize; ++Index)
+			{
+				Blocks[Index] = BenchmarkPool.Allocate(BenchmarkBlockSize);
+			}
+			for (int32 Index = 0; Index < BatchSize; ++Index)
+			{
+				BenchmarkPool.Free(Blocks[Index], BenchmarkBlockSize);
+			}
+		}
+	};
+
+	auto RunMalloc = [&]()
+	{
+		TArray<void*> Blocks;
+		Blocks.SetNumUninitialized(BatchSize);
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			for (int32 Index = 0; Index < BatchSize; ++Index)
+			{
+				Blocks[Index] = FMemory::Malloc(BenchmarkBlockSize, BenchmarkBlockAlignment);
+			}
+			for (int32 Index = 0; Index < BatchSize; ++Index)
+			{
+				FMemory::Free(Blocks[Index]);
+			}
+		}
+	};
+
+	auto TimeMs = [](TFunctionRef<void()> Body)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		Body();
+		return (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	};
+
+	// Warm both up so the pool's free list and the allocator's bins are populated before timing
+	RunPool();
+	RunMalloc();
+
+	const double NumOps = (double)NumIterations * (double)BatchSize;
+
+	const double PoolMs = TimeMs(RunPool);
+	const double MallocMs = TimeMs(RunMalloc);
+	Ar.Logf(TEXT("1 thread, %d x %d blocks of %d bytes: pool %.2f ms (%.1f ns/op), FMemory %.2f ms (%.1f ns/op)"),
+		NumIterations, BatchSize, (int32)BenchmarkBlockSize, PoolMs, PoolMs * 1.0e6 / NumOps, MallocMs, MallocMs * 1.0e6 / NumOps);
+
+	if (NumThreads > 1)
+	{
+		// Every thread hits the same pool, which is the contended case the critical section has to hold up in
+		const double ThreadedPoolMs = TimeMs([&]() { ParallelFor(NumThreads, [&](int32) { RunPool(); }); });
+		const double ThreadedMallocMs = TimeMs([&]() { ParallelFor(NumThreads, [&](int32) { RunMalloc(); }); });
+		Ar.Logf(TEXT("%d threads, %d x %d blocks each: pool %.2f ms (%.1f ns/op), FMemory %.2f ms (%.1f ns/op)"),
+			NumThreads, NumIterations, BatchSize, ThreadedPoolMs, ThreadedPoolMs * 1.0e6 / (NumOps * NumThreads), ThreadedMallocMs, ThreadedMallocMs * 1.0e6 / (NumOps * NumThreads));
+	}
+}
+#endif
+
+static FAutoConsoleCommandWithOutputDevice DumpAllocationPoolsCommand(
+	TEXT("Lyra.AllocationPool.Dump"),
+	TEXT("Prints the allocation counts and hit rate of the pools used for effect contexts and target data, and how many of each are live"),
+	FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&DumpAllocationPoolsAndCounters));
@@ -0,0 +1,120 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "HAL/CriticalSection.h"
+#include "Containers/Array.h"
+
+#include <atomic>
+
+class FOutputDevice;
+
+/**
+ * FLyraAllocationPool
+ *
+ *	Thread-safe pool of fixed size memory blocks, used for small structs that are allocated and released at a
+ *	high rate (effect contexts, target data) so they can be recycled instead of going back to the allocator.
+ *	Types opt in by forwarding their class operator new/delete to a pool (see LYRA_DECLARE_POOLED_ALLOCATION).
+ *	Blocks of any other size (e.g., from a derived type) are passed straight through to FMemory.
+ *
+ *	Free also receives blocks the pool never handed out: replication builds these structs with FMemory::Malloc and
+ *	UScriptStruct::InitializeStruct, and the owning handle later deletes them through the class operator delete.
+ *	Those blocks are the same size and alignment, so they are adopted into the free list, but it means the pool
+ *	can't track a live count; it reports allocations and releases separately (see FLyraLiveObjectCounter for live counts).
+ */
+class FLyraAllocationPool
+{
+public:
+	LYRAGAME_API FLyraAllocationPool(const TCHAR* InName, SIZE_T InBlockSize, uint32 InBlockAlignment);
+
+	LYRAGAME_API void* Allocate(SIZE_T Size);
+	LYRAGAME_API void Free(void* Ptr, SIZE_T Size);
+
+	/** Writes the allocation counts and hit rate of every pool (and the live object counts) to the output device */
+	static LYRAGAME_API void DumpAllPools(FOutputDevice& Ar);
+
+#if !UE_BUILD_SHIPPING
+	/** Times NumIterations rounds of allocating and then freeing BatchSize blocks, through a pool and straight through FMemory, on one thread and on NumThreads at once */
+	static LYRAGAME_API void BenchmarkAgainstMalloc(int32 NumIterations, int32 BatchSize, int32 NumThreads, FOutputDevice& Ar);
+#endif
+
+private:
+	const TCHAR* Name;
+	SIZE_T BlockSize;
+	uint32 BlockAlignment;
+
+	FCriticalSection FreeBlocksLock;
+	TArray<void*> FreeBlocks;
+
+	std::atomic<uint64> NumHits = 0;
+	std::atomic<uint64> NumMisses = 0;
+	std::atomic<uint64> NumReleases = 0;
+
+	FLyraAllocationPool* NextPool = nullptr;
+};
+
+/**
+ * FLyraLiveObjectCounter
+ *
+ *	Number of live instances of a pooled type. Counted from the type's constructors and destructor (see TLyraLiveObjectToken)
+ *	rather than by the pool, so objects built outside of it (e.g., by replication) are included and the count can't drift.
+ */
+class FLyraLiveObjectCounter
+{
+public:
+	LYRAGAME_API explicit FLyraLiveObjectCounter(const TCHAR* InName);
+
+	LYRAGAME_API void Increment();
+	LYRAGAME_API void Decrement();
+
+	/** Writes the live and peak count of every counter to the output device */
+	static LYRAGAME_API void DumpAllCounters(FOutputDevice& Ar);
+
+private:
+	const TCHAR* Name;
+
+	std::atomic<int32> NumLive = 0;
+	std::atomic<int32> PeakLive = 0;
+
+	FLyraLiveObjectCounter* NextCounter = nullptr;
+};
+
+/**
+ * Member that counts the live instances of its owning type T in T::GetLiveObjectCounter(),
+ * from every constructor (including copies) and the destructor
+ */
+template <typename T>
+struct TLyraLiveObjectToken
+{
+	TLyraLiveObjectToken() { T::GetLiveObjectCounter().Increment(); }
+	TLyraLiveObjectToken(const TLyraLiveObjectToken&) { T::GetLiveObjectCounter().Increment(); }
+	TLyraLiveObjectToken& operator=(const TLyraLiveObjectToken&) { return *this; }
+	~TLyraLiveObjectToken() { T::GetLiveObjectCounter().Decrement(); }
+};
+
+/**
+ * Declares a class operator new/delete that allocates from a FLyraAllocationPool, along with the type's live object counter,
+ * implement them in the .cpp with LYRA_IMPLEMENT_POOLED_ALLOCATION
+ */
+#define LYRA_DECLARE_POOLED_ALLOCATION() \
+	static FLyraLiveObjectCounter& GetLiveObjectCounter(); \
+	static void* operator new(size_t Size); \
+	static void operator delete(void* Ptr, size_t Size); \
+	/* Placement new is hidden by the class operator new otherwise (used by UScriptStruct to construct in place) */ \
+	static void* operator new(size_t Size, void* Place) { return Place; } \
+	static void operator delete(void* Ptr, void* Place) {}
+
+#define LYRA_IMPLEMENT_POOLED_ALLOCATION(Type) \
+	static FLyraAllocationPool& Get##Type##Pool() \
+	{ \
+		/* Never destroyed, blocks can still be released during static shutdown */ \
+		static FLyraAllocationPool& Pool = *new FLyraAllocationPool(TEXT(#Type), sizeof(Type), alignof(Type)); \
+		return Pool; \
+	} \
+	FLyraLiveObjectCounter& Type::GetLiveObjectCounter() \
+	{ \
+		static FLyraLiveObjectCounter& Counter = *new FLyraLiveObjectCounter(TEXT(#Type)); \
+		return Counter; \
+	} \
+	void* Type::operator new(size_t Size) { return Get##Type##Pool().Allocate(Size); } \
+	void Type::operator delete(void* Ptr, size_t Size) { Get##Type##Pool().Free(Ptr, Size); }
@@ -10,6 +10,8 @@ struct FGameplayEffectContextHandle;
 
 //////////////////////////////////////////////////////////////////////
 
+LYRA_IMPLEMENT_POOLED_ALLOCATION(FLyraGameplayAbilityTargetData_SingleTargetHit)
+
 void FLyraGameplayAbilityTargetData_SingleTargetHit::AddTargetDataToContext(FGameplayEffectContextHandle& Context, bool bIncludeActorArray) const
 {
 	FGameplayAbilityTargetData_SingleTargetHit::AddTargetDataToContext(Context, bIncludeActorArray);
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Abilities/GameplayAbilityTargetTypes.h"
+#include "AbilitySystem/LyraAllocationPool.h"
 
 #include "LyraGameplayAbilityTargetData_SingleTargetHit.generated.h"
 
@@ -20,6 +21,9 @@ struct FLyraGameplayAbilityTargetData_SingleTargetHit : public FGameplayAbilityT
 		: CartridgeID(-1)
 	{ }
 
+	// One of these is allocated per bullet hit, so they are recycled through a pool
+	LYRA_DECLARE_POOLED_ALLOCATION()
+
 	virtual void AddTargetDataToContext(FGameplayEffectContextHandle& Context, bool bIncludeActorArray) const override;
 
 	/** ID to allow the identification of multiple bullets that were part of the same cartridge */
@@ -32,6 +36,10 @@ struct FLyraGameplayAbilityTargetData_SingleTargetHit : public FGameplayAbilityT
 	{
 		return FLyraGameplayAbilityTargetData_SingleTargetHit::StaticStruct();
 	}
+
+private:
+	/** Counts live target data, however it was constructed (see Lyra.AllocationPool.Dump) */
+	TLyraLiveObjectToken<FLyraGameplayAbilityTargetData_SingleTargetHit> LiveObjectToken;
 };
 
 template<>
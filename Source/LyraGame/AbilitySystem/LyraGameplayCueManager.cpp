@@ -8,9 +8,26 @@
 #include "GameplayTagsManager.h"
 #include "UObject/UObjectThreadContext.h"
 #include "Async/Async.h"
+#include "AbilitySystem/LyraAbilitySet.h"
+#include "Abilities/GameplayAbility.h"
+#include "Character/LyraPawnData.h"
+#include "Equipment/LyraEquipmentDefinition.h"
+#include "GameFeatureAction.h"
+#include "GameModes/LyraExperienceActionSet.h"
+#include "GameModes/LyraExperienceDefinition.h"
+#include "GameplayEffect.h"
+#include "Inventory/LyraInventoryItemDefinition.h"
+#include "UObject/UObjectIterator.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/CoreDelegates.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Weapons/LyraWeaponFiringStats.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraGameplayCueManager)
 
+CSV_DECLARE_CATEGORY_EXTERN(LyraPerformance);
+
 //////////////////////////////////////////////////////////////////////
 
 enum class ELyraEditorLoadMode
@@ -35,12 +52,150 @@ namespace LyraGameplayCueManagerCvars
 		FConsoleCommandWithArgsDelegate::CreateStatic(ULyraGameplayCueManager::DumpGameplayCues));
 
 	static ELyraEditorLoadMode LoadMode = ELyraEditorLoadMode::LoadUpfront;
+
+	static bool bAggregateExecutedCues = true;
+	static FAutoConsoleVariableRef CVarAggregateExecutedCues(
+		TEXT("Lyra.GameplayCues.AggregateExecuted"),
+		bAggregateExecutedCues,
+		TEXT("Should executed gameplay cues be gathered up and dispatched at the end of the frame, merging identical cues from the same instigator on the same target (keeping the first hit's location)?"),
+		ECVF_Default);
+
+	static int32 MaxExecutedCuesPerTagPerFrame = 8;
+	static FAutoConsoleVariableRef CVarMaxExecutedCuesPerTagPerFrame(
+		TEXT("Lyra.GameplayCues.MaxExecutedPerTagPerFrame"),
+		MaxExecutedCuesPerTagPerFrame,
+		TEXT("Maximum number of executed cues dispatched per cue tag per frame, counted after merging (the ones closest to a local viewer win). 0 means no limit."),
+		ECVF_Default);
+
+	static float MaxExecutedCueDistance = 0.0f;
+	static FAutoConsoleVariableRef CVarMaxExecutedCueDistance(
+		TEXT("Lyra.GameplayCues.MaxExecutedDistance"),
+		MaxExecutedCueDistance,
+		TEXT("Executed cues further than this from every local viewer are dropped when aggregating. 0 means no limit."),
+		ECVF_Default);
 }
 
 const bool bPreloadEvenInEditor = true;
 
 //////////////////////////////////////////////////////////////////////
 
+namespace LyraGameplayCueManagerPreload
+{
+	// Walks the properties of experience related content looking for gameplay cue tags, following references to
+	// pawn data, action sets, ability sets, abilities, effects, equipment, and items along with any instanced subobjects
+	struct FCueTagGatherer
+	{
+		TSet<FGameplayTag> CueTags;
+		TSet<const UObject*> VisitedObjects;
+
+		void GatherFromObject(const UObject* Object)
+		{
+			if ((Object == nullptr) || VisitedObjects.Contains(Object))
+			{
+				return;
+			}
+			VisitedObjects.Add(Object);
+
+			GatherFromStruct(Object->GetClass(), Object);
+		}
+
+		void GatherFromClass(const UClass* Class)
+		{
+			if (Class && ShouldFollowClass(Class))
+			{
+				GatherFromObject(Class->GetDefaultObject());
+			}
+		}
+
+	private:
+		static bool ShouldFollowClass(const UClass* Class)
+		{
+			return Class->IsChildOf(UGameplayAbility::StaticClass())
+				|| Class->IsChildOf(UGameplayEffect::StaticClass())
+				|| Class->IsChildOf(ULyraEquipmentDefinition::StaticClass())
+				|| Class->IsChildOf(ULyraInventoryItemDefinition::StaticClass());
+		}
+
+		static bool ShouldFollowObject(const UObject* Object)
+		{
+			return Object->IsA<ULyraPawnData>()
+				|| Object->IsA<ULyraExperienceActionSet>()
+				|| Object->IsA<ULyraAbilitySet>();
+		}
+
+		void GatherFromStruct(const UStruct* Struct, const void* Data)
+		{
+			for (TFieldIterator<FProperty> PropIt(Struct); PropIt; ++PropIt)
+			{
+				const FProperty* Property = *PropIt;
+				for (int32 ArrayIndex = 0; ArrayIndex < Property->ArrayDim; ++ArrayIndex)
+				{
+					GatherFromValue(Property, Property->ContainerPtrToValuePtr<void>(Data, ArrayIndex));
+				}
+			}
+		}
+
+		void GatherFromValue(const FProperty* Property, const void* ValuePtr)
+		{
+			if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+			{
+				if (StructProperty->Struct == FGameplayTag::StaticStruct())
+				{
+					AddTag(*static_cast<const FGameplayTag*>(ValuePtr));
+				}
+				else if (StructProperty->Struct == FGameplayTagContainer::StaticStruct())
+				{
+					for (const FGameplayTag& Tag : *static_cast<const FGameplayTagContainer*>(ValuePtr))
+					{
+						AddTag(Tag);
+					}
+				}
+				else
+				{
+					GatherFromStruct(StructProperty->Struct, ValuePtr);
+				}
+			}
+			else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+			{
+				FScriptArrayHelper ArrayHelper(ArrayProperty, ValuePtr);
+				for (int32 Index = 0; Index < ArrayHelper.Num(); ++Index)
+				{
+					GatherFromValue(ArrayProperty->Inner, ArrayHelper.GetRawPtr(Index));
+				}
+			}
+			else if (const FClassProperty* ClassProperty = CastField<FClassProperty>(Property))
+			{
+				GatherFromClass(Cast<UClass>(ClassProperty->GetObjectPropertyValue(ValuePtr)));
+			}
+			else if (const FSoftClassProperty* SoftClassProperty = CastField<FSoftClassProperty>(Property))
+			{
+				// Only follow what is already loaded, the experience bundles have been loaded by now
+				GatherFromClass(Cast<UClass>(SoftClassProperty->GetObjectPropertyValue(ValuePtr)));
+			}
+			else if (const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property))
+			{
+				if (const UObject* Object = ObjectProperty->GetObjectPropertyValue(ValuePtr))
+				{
+					if (Property->HasAnyPropertyFlags(CPF_InstancedReference | CPF_PersistentInstance) || ShouldFollowObject(Object))
+					{
+						GatherFromObject(Object);
+					}
+				}
+			}
+		}
+
+		void AddTag(const FGameplayTag& Tag)
+		{
+			if (Tag.MatchesTag(UGameplayCueSet::BaseGameplayCueTag()))
+			{
+				CueTags.Add(Tag);
+			}
+		}
+	};
+}
+
+//////////////////////////////////////////////////////////////////////
+
 struct FGameplayCueTagThreadSynchronizeGraphTask : public FAsyncGraphTaskBase
 {
 	TFunction<void()> TheTask;
@@ -66,6 +221,15 @@ void ULyraGameplayCueManager::OnCreated()
 	Super::OnCreated();
 
 	UpdateDelayLoadDelegateListeners();
+
+	FCoreDelegates::OnEndFrame.AddUObject(this, &ThisClass::FlushPendingExecutedCues);
+}
+
+void ULyraGameplayCueManager::BeginDestroy()
+{
+	FCoreDelegates::OnEndFrame.RemoveAll(this);
+
+	Super::BeginDestroy();
 }
 
 void ULyraGameplayCueManager::LoadAlwaysLoadedCues()
@@ -123,6 +287,199 @@ bool ULyraGameplayCueManager::ShouldAsyncLoadMissingGameplayCues() const
 	return true;
 }
 
+void ULyraGameplayCueManager::HandleGameplayCue(AActor* TargetActor, FGameplayTag GameplayCueTag, EGameplayCueEvent::Type EventType, const FGameplayCueParameters& Parameters, EGameplayCueExecutionOptions Options)
+{
+	FLyraWeaponFiringStatScope FiringStatScope(ELyraWeaponFiringStage::GameplayCueDispatch);
+
+	if (!ShouldAggregateExecutedCue(TargetActor, EventType))
+	{
+		DispatchGameplayCue(TargetActor, GameplayCueTag, EventType, Parameters, Options);
+		return;
+	}
+
+	const FPendingExecutedCueKey Key(FObjectKey(TargetActor), FObjectKey(Parameters.Instigator.Get()), GameplayCueTag, Options);
+	if (const int32* ExistingIndex = PendingExecutedCueIndices.Find(Key))
+	{
+		// Same cue from the same instigator on the same target this frame (e.g., several pellets of a shotgun blast), fold it into the pending one.
+		// The first hit stays as the representative location / hit result, only the magnitudes accumulate.
+		FGameplayCueParameters& MergedParameters = PendingExecutedCues[*ExistingIndex].Parameters;
+		MergedParameters.RawMagnitude += Parameters.RawMagnitude;
+		MergedParameters.NormalizedMagnitude = FMath::Min(MergedParameters.NormalizedMagnitude + Parameters.NormalizedMagnitude, 1.0f);
+		++NumPendingExecutedCuesMerged;
+	}
+	else
+	{
+		PendingExecutedCueIndices.Add(Key, PendingExecutedCues.Num());
+
+		FPendingExecutedCue& PendingCue = PendingExecutedCues.AddDefaulted_GetRef();
+		PendingCue.TargetActor = TargetActor;
+		PendingCue.GameplayCueTag = GameplayCueTag;
+		PendingCue.Parameters = Parameters;
+		PendingCue.Options = Options;
+	}
+}
+
+void ULyraGameplayCueManager::DispatchGameplayCue(AActor* TargetActor, FGameplayTag GameplayCueTag, EGameplayCueEvent::Type EventType, const FGameplayCueParameters& Parameters, EGameplayCueExecutionOptions Options)
+{
+	// Keep track of cues that are still being loaded the first time they are used (they'll be missed or played late)
+	if (ShouldDelayLoadGameplayCues() && RuntimeGameplayCueObjectLibrary.CueSet)
+	{
+		const int32 DataIdx = FindGameplayCueDataIndex(GameplayCueTag);
+		if (DataIdx != INDEX_NONE)
+		{
+			const FGameplayCueNotifyData& CueData = RuntimeGameplayCueObjectLibrary.CueSet->GameplayCueData[DataIdx];
+			if (CueData.LoadedGameplayCueClass == nullptr)
+			{
+				int32& NumHitches = FirstUseHitches.FindOrAdd(GameplayCueTag, 0);
+				if (NumHitches++ == 0)
+				{
+					UE_LOG(LogLyra, Log, TEXT("Gameplay cue %s (%s) was triggered before it was loaded"), *GameplayCueTag.ToString(), *CueData.GameplayCueNotifyObj.ToString());
+				}
+			}
+		}
+	}
+
+	Super::HandleGameplayCue(TargetActor, GameplayCueTag, EventType, Parameters, Options);
+}
+
+int32 ULyraGameplayCueManager::FindGameplayCueDataIndex(FGameplayTag Tag) const
+{
+	check(RuntimeGameplayCueObjectLibrary.CueSet);
+
+	// Cues without their own notify are handled by the closest parent that has one
+	const TMap<FGameplayTag, int32>& DataMap = RuntimeGameplayCueObjectLibrary.CueSet->GameplayCueDataMap;
+	for (FGameplayTag CurrentTag = Tag; CurrentTag.IsValid(); CurrentTag = CurrentTag.RequestDirectParent())
+	{
+		if (const int32* DataIdx = DataMap.Find(CurrentTag))
+		{
+			return RuntimeGameplayCueObjectLibrary.CueSet->GameplayCueData.IsValidIndex(*DataIdx) ? *DataIdx : INDEX_NONE;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+bool ULyraGameplayCueManager::ShouldAggregateExecutedCue(AActor* TargetActor, EGameplayCueEvent::Type EventType) const
+{
+	// Only one-shot cues can be merged or dropped, the others track state on the target
+	return LyraGameplayCueManagerCvars::bAggregateExecutedCues
+		&& (EventType == EGameplayCueEvent::Executed)
+		&& (TargetActor != nullptr)
+		&& !IsRunningDedicatedServer();
+}
+
+void ULyraGameplayCueManager::FlushPendingExecutedCues()
+{
+	if (PendingExecutedCues.Num() == 0)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_LyraGameplayCueManager_FlushPendingExecutedCues);
+	FLyraWeaponFiringStatScope FiringStatScope(ELyraWeaponFiringStage::GameplayCueDispatch);
+
+	// Take the pending cues first, dispatching a cue can cause more to be executed (which will wait for the next flush)
+	TArray<FPendingExecutedCue> CuesToDispatch = MoveTemp(PendingExecutedCues);
+	const int32 NumMerged = NumPendingExecutedCuesMerged;
+	PendingExecutedCues.Reset();
+	PendingExecutedCueIndices.Reset();
+	NumPendingExecutedCuesMerged = 0;
+
+	// Work out how far each cue is from the nearest local viewer
+	TArray<TPair<const UWorld*, TArray<FVector, TInlineAllocator<2>>>, TInlineAllocator<2>> ViewLocationsByWorld;
+	for (FPendingExecutedCue& PendingCue : CuesToDispatch)
+	{
+		AActor* TargetActor = PendingCue.TargetActor.Get();
+		const UWorld* World = TargetActor ? TargetActor->GetWorld() : nullptr;
+		if (World == nullptr)
+		{
+			continue;
+		}
+
+		auto* ViewLocations = ViewLocationsByWorld.FindByPredicate([World](const auto& Pair) { return Pair.Key == World; });
+		if (ViewLocations == nullptr)
+		{
+			ViewLocations = &ViewLocationsByWorld.Emplace_GetRef(World, TArray<FVector, TInlineAllocator<2>>());
+			for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+			{
+				const APlayerController* PC = It->Get();
+				if (PC && PC->IsLocalController())
+				{
+					FVector ViewLocation;
+					FRotator ViewRotation;
+					PC->GetPlayerViewPoint(/*out*/ ViewLocation, /*out*/ ViewRotation);
+					ViewLocations->Value.Add(ViewLocation);
+				}
+			}
+		}
+
+		const FVector CueLocation = PendingCue.Parameters.Location.IsZero() ? TargetActor->GetActorLocation() : FVector(PendingCue.Parameters.Location);
+
+		PendingCue.DistanceSqToViewer = 0.0;
+		if (ViewLocations->Value.Num() > 0)
+		{
+			PendingCue.DistanceSqToViewer = TNumericLimits<double>::Max();
+			for (const FVector& ViewLocation : ViewLocations->Value)
+			{
+				PendingCue.DistanceSqToViewer = FMath::Min(PendingCue.DistanceSqToViewer, FVector::DistSquared(ViewLocation, CueLocation));
+			}
+		}
+	}
+
+	// Closest cues of each tag first, so the budget goes to the ones that matter most
+	CuesToDispatch.Sort([](const FPendingExecutedCue& A, const FPendingExecutedCue& B)
+	{
+		if (A.GameplayCueTag != B.GameplayCueTag)
+		{
+			return A.GameplayCueTag.GetTagName().FastLess(B.GameplayCueTag.GetTagName());
+		}
+		return A.DistanceSqToViewer < B.DistanceSqToViewer;
+	});
+
+	const int32 MaxPerTag = LyraGameplayCueManagerCvars::MaxExecutedCuesPerTagPerFrame;
+	const double MaxDistanceSq = FMath::Square((double)LyraGameplayCueManagerCvars::MaxExecutedCueDistance);
+
+	int32 NumDispatched = 0;
+	int32 NumDropped = 0;
+	int32 NumDispatchedForTag = 0;
+	FGameplayTag CurrentTag;
+
+	for (const FPendingExecutedCue& PendingCue : CuesToDispatch)
+	{
+		if (PendingCue.GameplayCueTag != CurrentTag)
+		{
+			CurrentTag = PendingCue.GameplayCueTag;
+			NumDispatchedForTag = 0;
+		}
+
+		AActor* TargetActor = PendingCue.TargetActor.Get();
+		if (TargetActor == nullptr)
+		{
+			continue;
+		}
+
+		const bool bOverBudget = (MaxPerTag > 0) && (NumDispatchedForTag >= MaxPerTag);
+		const bool bTooFar = (MaxDistanceSq > 0.0) && (PendingCue.DistanceSqToViewer > MaxDistanceSq);
+		if (bOverBudget || bTooFar)
+		{
+			++NumDropped;
+			continue;
+		}
+
+		DispatchGameplayCue(TargetActor, PendingCue.GameplayCueTag, EGameplayCueEvent::Executed, PendingCue.Parameters, PendingCue.Options);
+		++NumDispatchedForTag;
+		++NumDispatched;
+	}
+
+	CSV_CUSTOM_STAT(LyraPerformance, GameplayCuesExecuted, NumDispatched, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LyraPerformance, GameplayCuesMerged, NumMerged, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LyraPerformance, GameplayCuesDropped, NumDropped, ECsvCustomStatOp::Set);
+
+	NumExecutedCuesDispatched += NumDispatched;
+	NumExecutedCuesMerged += NumMerged;
+	NumExecutedCuesDropped += NumDropped;
+}
+
 void ULyraGameplayCueManager::DumpGameplayCues(const TArray<FString>& Args)
 {
 	ULyraGameplayCueManager* GCM = Cast<ULyraGameplayCueManager>(UAbilitySystemGlobals::Get().GetGameplayCueManager());
@@ -175,6 +532,17 @@ void ULyraGameplayCueManager::DumpGameplayCues(const TArray<FString>& Args)
 	UE_LOG(LogLyra, Log, TEXT("  ... %d cues in preloaded list"), GCM->PreloadedCues.Num());
 	UE_LOG(LogLyra, Log, TEXT("  ... %d cues loaded on demand"), NumMissingCuesLoaded);
 	UE_LOG(LogLyra, Log, TEXT("  ... %d cues in total"), GCM->AlwaysLoadedCues.Num() + GCM->PreloadedCues.Num() + NumMissingCuesLoaded);
+
+	UE_LOG(LogLyra, Log, TEXT("=========== Gameplay Cues that were not loaded on first use ==========="));
+	for (const TPair<FGameplayTag, int32>& Hitch : GCM->FirstUseHitches)
+	{
+		UE_LOG(LogLyra, Log, TEXT("  %s (%d times)"), *Hitch.Key.ToString(), Hitch.Value);
+	}
+
+	UE_LOG(LogLyra, Log, TEXT("=========== Executed Gameplay Cue aggregation summary ==========="));
+	UE_LOG(LogLyra, Log, TEXT("  ... %lld executed cues dispatched"), GCM->NumExecutedCuesDispatched);
+	UE_LOG(LogLyra, Log, TEXT("  ... %lld executed cues merged into another on the same target"), GCM->NumExecutedCuesMerged);
+	UE_LOG(LogLyra, Log, TEXT("  ... %lld executed cues dropped by budget or distance"), GCM->NumExecutedCuesDropped);
 }
 
 void ULyraGameplayCueManager::OnGameplayTagLoaded(const FGameplayTag& Tag)
@@ -299,6 +667,89 @@ void ULyraGameplayCueManager::OnPreloadCueComplete(FSoftObjectPath Path, TWeakOb
 	}
 }
 
+TSharedPtr<FStreamableHandle> ULyraGameplayCueManager::PreloadCuesForExperience(const ULyraExperienceDefinition* Experience)
+{
+	if ((Experience == nullptr) || !ShouldDelayLoadGameplayCues() || (RuntimeGameplayCueObjectLibrary.CueSet == nullptr))
+	{
+		return nullptr;
+	}
+
+	switch (LyraGameplayCueManagerCvars::LoadMode)
+	{
+	case ELyraEditorLoadMode::LoadUpfront:
+		return nullptr;
+	case ELyraEditorLoadMode::PreloadAsCuesAreReferenced_GameOnly:
+#if WITH_EDITOR
+		if (GIsEditor)
+		{
+			return nullptr;
+		}
+#endif
+		break;
+	case ELyraEditorLoadMode::PreloadAsCuesAreReferenced:
+		break;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	LyraGameplayCueManagerPreload::FCueTagGatherer Gatherer;
+	Gatherer.GatherFromObject(Experience);
+
+	// Equipment is usually granted by content the experience doesn't reference directly, so include anything that is already loaded
+	for (TObjectIterator<UClass> ClassIt; ClassIt; ++ClassIt)
+	{
+		if (ClassIt->IsChildOf(ULyraEquipmentDefinition::StaticClass()) && !ClassIt->HasAnyClassFlags(CLASS_Abstract | CLASS_NewerVersionExists))
+		{
+			Gatherer.GatherFromObject(ClassIt->GetDefaultObject());
+		}
+	}
+
+	TArray<FSoftObjectPath> PathsToLoad;
+	for (const FGameplayTag& CueTag : Gatherer.CueTags)
+	{
+		const int32 DataIdx = FindGameplayCueDataIndex(CueTag);
+		if (DataIdx == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FGameplayCueNotifyData& CueData = RuntimeGameplayCueObjectLibrary.CueSet->GameplayCueData[DataIdx];
+		if (UClass* LoadedGameplayCueClass = FindObject<UClass>(nullptr, *CueData.GameplayCueNotifyObj.ToString()))
+		{
+			RegisterPreloadedCue(LoadedGameplayCueClass, const_cast<ULyraExperienceDefinition*>(Experience));
+		}
+		else
+		{
+			PathsToLoad.AddUnique(CueData.GameplayCueNotifyObj);
+		}
+	}
+
+	UE_LOG(LogLyraExperience, Log, TEXT("Found %d gameplay cues reachable from %s (%d need loading) in %.2f ms"),
+		Gatherer.CueTags.Num(), *GetNameSafe(Experience), PathsToLoad.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	if (PathsToLoad.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	TWeakObjectPtr<UObject> WeakOwner = const_cast<ULyraExperienceDefinition*>(Experience);
+	return StreamableManager.RequestAsyncLoad(PathsToLoad, FStreamableDelegate::CreateUObject(this, &ThisClass::OnExperienceCuesPreloadComplete, PathsToLoad, WeakOwner), FStreamableManager::DefaultAsyncLoadPriority, false, false, TEXT("GameplayCueManager"));
+}
+
+void ULyraGameplayCueManager::OnExperienceCuesPreloadComplete(TArray<FSoftObjectPath> Paths, TWeakObjectPtr<UObject> OwningObject)
+{
+	if (OwningObject.IsValid())
+	{
+		for (const FSoftObjectPath& Path : Paths)
+		{
+			if (UClass* LoadedGameplayCueClass = Cast<UClass>(Path.ResolveObject()))
+			{
+				RegisterPreloadedCue(LoadedGameplayCueClass, OwningObject.Get());
+			}
+		}
+	}
+}
+
 void ULyraGameplayCueManager::RegisterPreloadedCue(UClass* LoadedGameplayCueClass, UObject* OwningObject)
 {
 	check(LoadedGameplayCueClass);
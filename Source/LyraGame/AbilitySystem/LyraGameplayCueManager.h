@@ -3,14 +3,15 @@
 #pragma once
 
 #include "GameplayCueManager.h"
+#include "UObject/ObjectKey.h"
 
 #include "LyraGameplayCueManager.generated.h"
 
 class FString;
+class ULyraExperienceDefinition;
 class UClass;
 class UObject;
 class UWorld;
-struct FObjectKey;
 
 /**
  * ULyraGameplayCueManager
@@ -32,26 +33,42 @@ public:
 	virtual bool ShouldAsyncLoadRuntimeObjectLibraries() const override;
 	virtual bool ShouldSyncLoadMissingGameplayCues() const override;
 	virtual bool ShouldAsyncLoadMissingGameplayCues() const override;
+	virtual void HandleGameplayCue(AActor* TargetActor, FGameplayTag GameplayCueTag, EGameplayCueEvent::Type EventType, const FGameplayCueParameters& Parameters, EGameplayCueExecutionOptions Options = EGameplayCueExecutionOptions::Default) override;
 	//~End of UGameplayCueManager interface
 
+	//~UObject interface
+	virtual void BeginDestroy() override;
+	//~End of UObject interface
+
 	static void DumpGameplayCues(const TArray<FString>& Args);
 
+	// Dispatches the executed cues that were aggregated this frame (called automatically at the end of every frame)
+	void FlushPendingExecutedCues();
+
 	// When delay loading cues, this will load the cues that must be always loaded anyway
 	void LoadAlwaysLoadedCues();
 
 	// Updates the bundles for the singular gameplay cue primary asset
 	void RefreshGameplayCuePrimaryAsset();
 
+	// Async loads every cue that the experience (its pawn data, ability sets, actions, and equipment) can trigger, so they aren't loaded on first use.
+	// Returns the handle for the load, or null if there was nothing to load.
+	TSharedPtr<FStreamableHandle> PreloadCuesForExperience(const ULyraExperienceDefinition* Experience);
+
 private:
 	void OnGameplayTagLoaded(const FGameplayTag& Tag);
 	void HandlePostGarbageCollect();
 	void ProcessLoadedTags();
 	void ProcessTagToPreload(const FGameplayTag& Tag, UObject* OwningObject);
 	void OnPreloadCueComplete(FSoftObjectPath Path, TWeakObjectPtr<UObject> OwningObject, bool bAlwaysLoadedCue);
+	void OnExperienceCuesPreloadComplete(TArray<FSoftObjectPath> Paths, TWeakObjectPtr<UObject> OwningObject);
+	int32 FindGameplayCueDataIndex(FGameplayTag Tag) const;
+	void DispatchGameplayCue(AActor* TargetActor, FGameplayTag GameplayCueTag, EGameplayCueEvent::Type EventType, const FGameplayCueParameters& Parameters, EGameplayCueExecutionOptions Options);
 	void RegisterPreloadedCue(UClass* LoadedGameplayCueClass, UObject* OwningObject);
 	void HandlePostLoadMap(UWorld* NewWorld);
 	void UpdateDelayLoadDelegateListeners();
 	bool ShouldDelayLoadGameplayCues() const;
+	bool ShouldAggregateExecutedCue(AActor* TargetActor, EGameplayCueEvent::Type EventType) const;
 
 private:
 	struct FLoadedGameplayTagToProcessData
@@ -63,6 +80,19 @@ private:
 		FLoadedGameplayTagToProcessData(const FGameplayTag& InTag, const TWeakObjectPtr<UObject>& InWeakOwner) : Tag(InTag), WeakOwner(InWeakOwner) {}
 	};
 
+	// An executed cue waiting to be dispatched at the end of the frame, identical ones from the same instigator on the same target are merged into it
+	struct FPendingExecutedCue
+	{
+		TWeakObjectPtr<AActor> TargetActor;
+		FGameplayTag GameplayCueTag;
+		FGameplayCueParameters Parameters;
+		EGameplayCueExecutionOptions Options = EGameplayCueExecutionOptions::Default;
+		double DistanceSqToViewer = 0.0;
+	};
+
+	// Target, instigator, cue tag, and options
+	using FPendingExecutedCueKey = TTuple<FObjectKey, FObjectKey, FGameplayTag, EGameplayCueExecutionOptions>;
+
 private:
 	// Cues that were preloaded on the client due to being referenced by content
 	UPROPERTY(transient)
@@ -73,6 +103,18 @@ private:
 	UPROPERTY(transient)
 	TSet<TObjectPtr<UClass>> AlwaysLoadedCues;
 
+	TArray<FPendingExecutedCue> PendingExecutedCues;
+	TMap<FPendingExecutedCueKey, int32> PendingExecutedCueIndices;
+	int32 NumPendingExecutedCuesMerged = 0;
+
+	// Totals since startup, see Lyra.DumpGameplayCues
+	int64 NumExecutedCuesDispatched = 0;
+	int64 NumExecutedCuesMerged = 0;
+	int64 NumExecutedCuesDropped = 0;
+
+	// Cues that were not loaded yet the first time they were triggered (and how many times that happened), see Lyra.DumpGameplayCues
+	TMap<FGameplayTag, int32> FirstUseHitches;
+
 	TArray<FLoadedGameplayTagToProcessData> LoadedGameplayTagsToProcess;
 	FCriticalSection LoadedGameplayTagsToProcessCS;
 	bool bProcessLoadedTagsAfterGC = false;
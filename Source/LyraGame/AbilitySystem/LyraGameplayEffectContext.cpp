@@ -15,6 +15,8 @@
 
 class FArchive;
 
+LYRA_IMPLEMENT_POOLED_ALLOCATION(FLyraGameplayEffectContext)
+
 FLyraGameplayEffectContext* FLyraGameplayEffectContext::ExtractEffectContext(struct FGameplayEffectContextHandle Handle)
 {
 	FGameplayEffectContext* BaseEffectContext = Handle.Get();
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "GameplayEffectTypes.h"
+#include "AbilitySystem/LyraAllocationPool.h"
 
 #include "LyraGameplayEffectContext.generated.h"
 
@@ -27,6 +28,9 @@ struct FLyraGameplayEffectContext : public FGameplayEffectContext
 	{
 	}
 
+	// Contexts are allocated for every effect application, so they are recycled through a pool
+	LYRA_DECLARE_POOLED_ALLOCATION()
+
 	/** Returns the wrapped FLyraGameplayEffectContext from the handle, or nullptr if it doesn't exist or is the wrong type */
 	static LYRAGAME_API FLyraGameplayEffectContext* ExtractEffectContext(struct FGameplayEffectContextHandle Handle);
 
@@ -68,6 +72,10 @@ protected:
 	/** Ability Source object (should implement ILyraAbilitySourceInterface). NOT replicated currently */
 	UPROPERTY()
 	TWeakObjectPtr<const UObject> AbilitySourceObject;
+
+private:
+	/** Counts live contexts, however they were constructed (see Lyra.AllocationPool.Dump) */
+	TLyraLiveObjectToken<FLyraGameplayEffectContext> LiveObjectToken;
 };
 
 template<>
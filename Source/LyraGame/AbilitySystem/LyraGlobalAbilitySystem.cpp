@@ -3,9 +3,22 @@
 #include "LyraGlobalAbilitySystem.h"
 
 #include "AbilitySystem/LyraAbilitySystemComponent.h"
+#include "LyraLogChannels.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraGlobalAbilitySystem)
 
+DECLARE_CYCLE_STAT(TEXT("LyraGlobalAbilitySystem ProcessPendingWork"), STAT_LyraGlobalAbilitySystem_ProcessPendingWork, STATGROUP_Game);
+
+namespace LyraGlobalAbilitySystemCVars
+{
+	static float FrameBudgetMs = 0.0f;
+	static FAutoConsoleVariableRef CVarFrameBudgetMs(
+		TEXT("Lyra.GlobalAbilitySystem.FrameBudgetMs"),
+		FrameBudgetMs,
+		TEXT("Time (in ms) per frame spent applying/removing global abilities and effects to registered ASCs (at least one is always done). If zero or less (the default), everything is done immediately."),
+		ECVF_Default);
+}
+
 void FGlobalAppliedAbilityList::AddToASC(TSubclassOf<UGameplayAbility> Ability, ULyraAbilitySystemComponent* ASC)
 {
 	if (FGameplayAbilitySpecHandle* SpecHandle = Handles.Find(ASC))
@@ -49,6 +62,7 @@ void FGlobalAppliedEffectList::AddToASC(TSubclassOf<UGameplayEffect> Effect, ULy
 		RemoveFromASC(ASC);
 	}
 
+	// Each ASC needs its own context (instigator, source object), executions and source captures depend on it
 	const UGameplayEffect* GameplayEffectCDO = Effect->GetDefaultObject<UGameplayEffect>();
 	const FActiveGameplayEffectHandle GameplayEffectHandle = ASC->ApplyGameplayEffectToSelf(GameplayEffectCDO, /*Level=*/ 1, ASC->MakeEffectContext());
 	Handles.Add(ASC, GameplayEffectHandle);
@@ -79,14 +93,29 @@ ULyraGlobalAbilitySystem::ULyraGlobalAbilitySystem()
 {
 }
 
+TStatId ULyraGlobalAbilitySystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULyraGlobalAbilitySystem, STATGROUP_Tickables);
+}
+
+void ULyraGlobalAbilitySystem::Tick(float DeltaTime)
+{
+	if (HasPendingWork())
+	{
+		ProcessPendingWork(LyraGlobalAbilitySystemCVars::FrameBudgetMs / 1000.0);
+	}
+}
+
 void ULyraGlobalAbilitySystem::ApplyAbilityToAll(TSubclassOf<UGameplayAbility> Ability)
 {
 	if ((Ability.Get() != nullptr) && (!AppliedAbilities.Contains(Ability)))
 	{
-		FGlobalAppliedAbilityList& Entry = AppliedAbilities.Add(Ability);		
-		for (ULyraAbilitySystemComponent* ASC : RegisteredASCs)
+		FGlobalAppliedAbilityList& Entry = AppliedAbilities.Add(Ability);
+		Entry.PendingASCs.Append(RegisteredASCs);
+
+		if (LyraGlobalAbilitySystemCVars::FrameBudgetMs <= 0.0f)
 		{
-			Entry.AddToASC(Ability, ASC);
+			FlushPendingWork();
 		}
 	}
 }
@@ -96,9 +125,11 @@ void ULyraGlobalAbilitySystem::ApplyEffectToAll(TSubclassOf<UGameplayEffect> Eff
 	if ((Effect.Get() != nullptr) && (!AppliedEffects.Contains(Effect)))
 	{
 		FGlobalAppliedEffectList& Entry = AppliedEffects.Add(Effect);
-		for (ULyraAbilitySystemComponent* ASC : RegisteredASCs)
+		Entry.PendingASCs.Append(RegisteredASCs);
+
+		if (LyraGlobalAbilitySystemCVars::FrameBudgetMs <= 0.0f)
 		{
-			Entry.AddToASC(Effect, ASC);
+			FlushPendingWork();
 		}
 	}
 }
@@ -108,7 +139,18 @@ void ULyraGlobalAbilitySystem::RemoveAbilityFromAll(TSubclassOf<UGameplayAbility
 	if ((Ability.Get() != nullptr) && AppliedAbilities.Contains(Ability))
 	{
 		FGlobalAppliedAbilityList& Entry = AppliedAbilities[Ability];
-		Entry.RemoveFromAll();
+		if (LyraGlobalAbilitySystemCVars::FrameBudgetMs <= 0.0f)
+		{
+			Entry.RemoveFromAll();
+		}
+		else
+		{
+			// Anything still pending never got the ability, the rest have it removed over the next few frames
+			for (const auto& KVP : Entry.Handles)
+			{
+				PendingAbilityRemovals.Emplace(KVP.Key, KVP.Value);
+			}
+		}
 		AppliedAbilities.Remove(Ability);
 	}
 }
@@ -118,7 +160,17 @@ void ULyraGlobalAbilitySystem::RemoveEffectFromAll(TSubclassOf<UGameplayEffect>
 	if ((Effect.Get() != nullptr) && AppliedEffects.Contains(Effect))
 	{
 		FGlobalAppliedEffectList& Entry = AppliedEffects[Effect];
-		Entry.RemoveFromAll();
+		if (LyraGlobalAbilitySystemCVars::FrameBudgetMs <= 0.0f)
+		{
+			Entry.RemoveFromAll();
+		}
+		else
+		{
+			for (const auto& KVP : Entry.Handles)
+			{
+				PendingEffectRemovals.Emplace(KVP.Key, KVP.Value);
+			}
+		}
 		AppliedEffects.Remove(Effect);
 	}
 }
@@ -127,6 +179,7 @@ void ULyraGlobalAbilitySystem::RegisterASC(ULyraAbilitySystemComponent* ASC)
 {
 	check(ASC);
 
+	// Late joiners get everything right away, rather than waiting behind any time-sliced work
 	for (auto& Entry : AppliedAbilities)
 	{
 		Entry.Value.AddToASC(Entry.Key, ASC);
@@ -145,12 +198,105 @@ void ULyraGlobalAbilitySystem::UnregisterASC(ULyraAbilitySystemComponent* ASC)
 	for (auto& Entry : AppliedAbilities)
 	{
 		Entry.Value.RemoveFromASC(ASC);
+		Entry.Value.PendingASCs.Remove(ASC);
 	}
 	for (auto& Entry : AppliedEffects)
 	{
 		Entry.Value.RemoveFromASC(ASC);
+		Entry.Value.PendingASCs.Remove(ASC);
 	}
 
 	RegisteredASCs.Remove(ASC);
 }
 
+bool ULyraGlobalAbilitySystem::HasPendingWork() const
+{
+	if ((PendingAbilityRemovals.Num() > 0) || (PendingEffectRemovals.Num() > 0))
+	{
+		return true;
+	}
+
+	for (const auto& Entry : AppliedAbilities)
+	{
+		if (Entry.Value.PendingASCs.Num() > 0)
+		{
+			return true;
+		}
+	}
+	for (const auto& Entry : AppliedEffects)
+	{
+		if (Entry.Value.PendingASCs.Num() > 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ULyraGlobalAbilitySystem::FlushPendingWork()
+{
+	ProcessPendingWork(/*BudgetSeconds=*/ 0.0);
+}
+
+void ULyraGlobalAbilitySystem::ProcessPendingWork(double BudgetSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LyraGlobalAbilitySystem_ProcessPendingWork);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const bool bUseBudget = (BudgetSeconds > 0.0);
+	int32 NumProcessed = 0;
+
+	// Always make some progress, even if a single application blows the budget
+	auto IsOverBudget = [&]()
+	{
+		return bUseBudget && (NumProcessed > 0) && ((FPlatformTime::Seconds() - StartTime) >= BudgetSeconds);
+	};
+
+	// Removals first, so re-applying something that was just removed doesn't leave both around for long
+	while ((PendingAbilityRemovals.Num() > 0) && !IsOverBudget())
+	{
+		const TPair<TWeakObjectPtr<ULyraAbilitySystemComponent>, FGameplayAbilitySpecHandle> Removal = PendingAbilityRemovals.Pop(EAllowShrinking::No);
+		if (ULyraAbilitySystemComponent* ASC = Removal.Key.Get())
+		{
+			ASC->ClearAbility(Removal.Value);
+		}
+		++NumProcessed;
+	}
+
+	while ((PendingEffectRemovals.Num() > 0) && !IsOverBudget())
+	{
+		const TPair<TWeakObjectPtr<ULyraAbilitySystemComponent>, FActiveGameplayEffectHandle> Removal = PendingEffectRemovals.Pop(EAllowShrinking::No);
+		if (ULyraAbilitySystemComponent* ASC = Removal.Key.Get())
+		{
+			ASC->RemoveActiveGameplayEffect(Removal.Value);
+		}
+		++NumProcessed;
+	}
+
+	for (auto& Entry : AppliedAbilities)
+	{
+		while ((Entry.Value.PendingASCs.Num() > 0) && !IsOverBudget())
+		{
+			if (ULyraAbilitySystemComponent* ASC = Entry.Value.PendingASCs.Pop(EAllowShrinking::No).Get())
+			{
+				Entry.Value.AddToASC(Entry.Key, ASC);
+			}
+			++NumProcessed;
+		}
+	}
+
+	for (auto& Entry : AppliedEffects)
+	{
+		while ((Entry.Value.PendingASCs.Num() > 0) && !IsOverBudget())
+		{
+			if (ULyraAbilitySystemComponent* ASC = Entry.Value.PendingASCs.Pop(EAllowShrinking::No).Get())
+			{
+				Entry.Value.AddToASC(Entry.Key, ASC);
+			}
+			++NumProcessed;
+		}
+	}
+
+	UE_LOG(LogLyraAbilitySystem, Verbose, TEXT("ULyraGlobalAbilitySystem processed %d global ability/effect changes in %.3f ms"), NumProcessed, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "ActiveGameplayEffectHandle.h"
+#include "GameplayEffectTypes.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "GameplayAbilitySpecHandle.h"
 #include "Templates/SubclassOf.h"
@@ -25,6 +26,9 @@ struct FGlobalAppliedAbilityList
 	UPROPERTY()
 	TMap<TObjectPtr<ULyraAbilitySystemComponent>, FGameplayAbilitySpecHandle> Handles;
 
+	/** ASCs that were registered when the ability was applied to all and haven't been given it yet */
+	TArray<TWeakObjectPtr<ULyraAbilitySystemComponent>> PendingASCs;
+
 	void AddToASC(TSubclassOf<UGameplayAbility> Ability, ULyraAbilitySystemComponent* ASC);
 	void RemoveFromASC(ULyraAbilitySystemComponent* ASC);
 	void RemoveFromAll();
@@ -38,19 +42,33 @@ struct FGlobalAppliedEffectList
 	UPROPERTY()
 	TMap<TObjectPtr<ULyraAbilitySystemComponent>, FActiveGameplayEffectHandle> Handles;
 
+	/** ASCs that were registered when the effect was applied to all and haven't had it applied yet */
+	TArray<TWeakObjectPtr<ULyraAbilitySystemComponent>> PendingASCs;
+
 	void AddToASC(TSubclassOf<UGameplayEffect> Effect, ULyraAbilitySystemComponent* ASC);
 	void RemoveFromASC(ULyraAbilitySystemComponent* ASC);
 	void RemoveFromAll();
 };
 
+/**
+ * ULyraGlobalAbilitySystem
+ *
+ *	Applies abilities and effects to every registered ASC (and any that register later).
+ *	Applying to or removing from all of the ASCs can be time-sliced across frames (see Lyra.GlobalAbilitySystem.FrameBudgetMs).
+ */
 UCLASS()
-class ULyraGlobalAbilitySystem : public UWorldSubsystem
+class ULyraGlobalAbilitySystem : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
 public:
 	ULyraGlobalAbilitySystem();
 
+	//~FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~End of FTickableGameObject interface
+
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Lyra")
 	void ApplyAbilityToAll(TSubclassOf<UGameplayAbility> Ability);
 
@@ -69,6 +87,16 @@ public:
 	/** Removes an ASC from the global system, along with any active global effects/abilities. */
 	void UnregisterASC(ULyraAbilitySystemComponent* ASC);
 
+	/** Returns true if there are global abilities/effects still waiting to be applied to or removed from some ASCs */
+	bool HasPendingWork() const;
+
+private:
+	/** Applies and removes pending global abilities/effects until the time budget runs out (does everything if the budget isn't positive) */
+	void ProcessPendingWork(double BudgetSeconds);
+
+	/** Gives every pending ASC the ability/effect right away */
+	void FlushPendingWork();
+
 private:
 	UPROPERTY()
 	TMap<TSubclassOf<UGameplayAbility>, FGlobalAppliedAbilityList> AppliedAbilities;
@@ -78,4 +106,8 @@ private:
 
 	UPROPERTY()
 	TArray<TObjectPtr<ULyraAbilitySystemComponent>> RegisteredASCs;
+
+	/** Global abilities/effects that were removed from all but haven't been removed from these ASCs yet */
+	TArray<TPair<TWeakObjectPtr<ULyraAbilitySystemComponent>, FGameplayAbilitySpecHandle>> PendingAbilityRemovals;
+	TArray<TPair<TWeakObjectPtr<ULyraAbilitySystemComponent>, FActiveGameplayEffectHandle>> PendingEffectRemovals;
 };
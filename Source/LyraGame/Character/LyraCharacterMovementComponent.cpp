@@ -7,6 +7,7 @@
 #include "Components/CapsuleComponent.h"
 #include "Engine/World.h"
 #include "GameFramework/Character.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraCharacterMovementComponent)
 
@@ -16,8 +17,15 @@ namespace LyraCharacter
 {
 	static float GroundTraceDistance = 100000.0f;
 	FAutoConsoleVariableRef CVar_GroundTraceDistance(TEXT("LyraCharacter.GroundTraceDistance"), GroundTraceDistance, TEXT("Distance to trace down when generating ground information."), ECVF_Cheat);
+
+	static bool bFloorQueriesReturnPhysicalMaterial = true;
+	FAutoConsoleVariableRef CVar_FloorQueriesReturnPhysicalMaterial(TEXT("LyraCharacter.FloorQueriesReturnPhysicalMaterial"), bFloorQueriesReturnPhysicalMaterial, TEXT("Should movement queries return physical materials, so the ground surface can be read from the current floor instead of tracing for it."), ECVF_Default);
 };
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ground Info Scene Queries"), STAT_LyraGroundInfoSceneQueries, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ground Surface Scene Queries"), STAT_LyraGroundSurfaceSceneQueries, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ground Surface Requests"), STAT_LyraGroundSurfaceRequests, STATGROUP_Game);
+
 
 ULyraCharacterMovementComponent::ULyraCharacterMovementComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -79,6 +87,7 @@ const FLyraCharacterGroundInfo& ULyraCharacterMovementComponent::GetGroundInfo()
 
 		FHitResult HitResult;
 		GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, CollisionChannel, QueryParams, ResponseParam);
+		INC_DWORD_STAT(STAT_LyraGroundInfoSceneQueries);
 
 		CachedGroundInfo.GroundHitResult = HitResult;
 		CachedGroundInfo.GroundDistance = LyraCharacter::GroundTraceDistance;
@@ -98,6 +107,50 @@ const FLyraCharacterGroundInfo& ULyraCharacterMovementComponent::GetGroundInfo()
 	return CachedGroundInfo;
 }
 
+const FLyraCharacterGroundSurfaceInfo& ULyraCharacterMovementComponent::GetGroundSurfaceInfo()
+{
+	INC_DWORD_STAT(STAT_LyraGroundSurfaceRequests);
+
+	if (!CharacterOwner || (GFrameCounter == CachedGroundSurfaceInfo.LastUpdateFrame))
+	{
+		return CachedGroundSurfaceInfo;
+	}
+
+	const FLyraCharacterGroundInfo& GroundInfo = GetGroundInfo();
+
+	FHitResult SurfaceHitResult = GroundInfo.GroundHitResult;
+
+	// The floor (or ground trace) hit usually has the physical material already, only trace when it doesn't
+	if (SurfaceHitResult.bBlockingHit && !SurfaceHitResult.PhysMaterial.IsValid())
+	{
+		const ECollisionChannel CollisionChannel = (UpdatedComponent ? UpdatedComponent->GetCollisionObjectType() : ECC_Pawn);
+		const FVector TraceStart(GetActorLocation());
+		const FVector TraceEnd(TraceStart.X, TraceStart.Y, (SurfaceHitResult.ImpactPoint.Z - 1.0f));
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(LyraCharacterMovementComponent_GetGroundSurfaceInfo), false, CharacterOwner);
+		FCollisionResponseParams ResponseParam;
+		InitCollisionParams(QueryParams, ResponseParam);
+		QueryParams.bReturnPhysicalMaterial = true;
+
+		FHitResult HitResult;
+		if (GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, CollisionChannel, QueryParams, ResponseParam))
+		{
+			SurfaceHitResult = HitResult;
+		}
+		INC_DWORD_STAT(STAT_LyraGroundSurfaceSceneQueries);
+	}
+
+	CachedGroundSurfaceInfo.SurfaceHitResult = SurfaceHitResult;
+	CachedGroundSurfaceInfo.bHasSurface = SurfaceHitResult.bBlockingHit;
+	CachedGroundSurfaceInfo.PhysicalMaterial = SurfaceHitResult.PhysMaterial;
+	CachedGroundSurfaceInfo.SurfaceType = UPhysicalMaterial::DetermineSurfaceType(SurfaceHitResult.PhysMaterial.Get());
+	CachedGroundSurfaceInfo.SurfaceNormal = SurfaceHitResult.bBlockingHit ? FVector(SurfaceHitResult.ImpactNormal) : FVector::UpVector;
+	CachedGroundSurfaceInfo.SurfaceDistance = GroundInfo.GroundDistance;
+	CachedGroundSurfaceInfo.LastUpdateFrame = GFrameCounter;
+
+	return CachedGroundSurfaceInfo;
+}
+
 void ULyraCharacterMovementComponent::SetReplicatedAcceleration(const FVector& InAcceleration)
 {
 	bHasReplicatedAcceleration = true;
@@ -117,6 +170,17 @@ FRotator ULyraCharacterMovementComponent::GetDeltaRotation(float DeltaTime) cons
 	return Super::GetDeltaRotation(DeltaTime);
 }
 
+void ULyraCharacterMovementComponent::InitCollisionParams(FCollisionQueryParams& OutParams, FCollisionResponseParams& OutResponseParam) const
+{
+	Super::InitCollisionParams(OutParams, OutResponseParam);
+
+	// Lets GetGroundSurfaceInfo read the surface from the current floor without another query
+	if (LyraCharacter::bFloorQueriesReturnPhysicalMaterial)
+	{
+		OutParams.bReturnPhysicalMaterial = true;
+	}
+}
+
 float ULyraCharacterMovementComponent::GetMaxSpeed() const
 {
 	if (UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(GetOwner()))
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "Chaos/ChaosEngineInterface.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "NativeGameplayTags.h"
 
@@ -10,6 +11,7 @@
 #define UE_API LYRAGAME_API
 
 class UObject;
+class UPhysicalMaterial;
 struct FFrame;
 
 LYRAGAME_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Gameplay_MovementStopped);
@@ -38,6 +40,41 @@ struct FLyraCharacterGroundInfo
 	float GroundDistance;
 };
 
+/**
+ * FLyraCharacterGroundSurfaceInfo
+ *
+ *	The surface under the character (physical material, surface type, normal), shared by everything that needs it
+ *	during a frame (e.g., footstep context effects) so they don't each trace for it.  It only gets updated as needed.
+ */
+USTRUCT(BlueprintType)
+struct FLyraCharacterGroundSurfaceInfo
+{
+	GENERATED_BODY()
+
+	uint64 LastUpdateFrame = 0;
+
+	// Hit against the ground, with its physical material
+	UPROPERTY(BlueprintReadOnly)
+	FHitResult SurfaceHitResult;
+
+	UPROPERTY(BlueprintReadOnly)
+	TWeakObjectPtr<UPhysicalMaterial> PhysicalMaterial;
+
+	UPROPERTY(BlueprintReadOnly)
+	TEnumAsByte<EPhysicalSurface> SurfaceType = EPhysicalSurface::SurfaceType_Default;
+
+	UPROPERTY(BlueprintReadOnly)
+	FVector SurfaceNormal = FVector::UpVector;
+
+	// Distance from the bottom of the capsule to the surface
+	UPROPERTY(BlueprintReadOnly)
+	float SurfaceDistance = 0.0f;
+
+	// False if there is no ground under the character (within LyraCharacter.GroundTraceDistance)
+	UPROPERTY(BlueprintReadOnly)
+	bool bHasSurface = false;
+};
+
 
 /**
  * ULyraCharacterMovementComponent
@@ -61,11 +98,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Lyra|CharacterMovement")
 	UE_API const FLyraCharacterGroundInfo& GetGroundInfo();
 
+	// Returns the surface under the character.  Calling this will update the surface info if it's out of date, reusing the ground info when it has a physical material.
+	UFUNCTION(BlueprintCallable, Category = "Lyra|CharacterMovement")
+	UE_API const FLyraCharacterGroundSurfaceInfo& GetGroundSurfaceInfo();
+
 	UE_API void SetReplicatedAcceleration(const FVector& InAcceleration);
 
 	//~UMovementComponent interface
 	UE_API virtual FRotator GetDeltaRotation(float DeltaTime) const override;
 	UE_API virtual float GetMaxSpeed() const override;
+	UE_API virtual void InitCollisionParams(FCollisionQueryParams& OutParams, FCollisionResponseParams& OutResponseParam) const override;
 	//~End of UMovementComponent interface
 
 protected:
@@ -77,6 +119,9 @@ protected:
 	// Cached ground info for the character.  Do not access this directly!  It's only updated when accessed via GetGroundInfo().
 	FLyraCharacterGroundInfo CachedGroundInfo;
 
+	// Cached ground surface info for the character.  Do not access this directly!  It's only updated when accessed via GetGroundSurfaceInfo().
+	FLyraCharacterGroundSurfaceInfo CachedGroundSurfaceInfo;
+
 	UPROPERTY(Transient)
 	bool bHasReplicatedAcceleration = false;
 };
@@ -2,10 +2,12 @@
 
 
 #include "AnimNotify_LyraContextEffects.h"
+#include "Character/LyraCharacterMovementComponent.h"
 #include "Feedback/ContextEffects/LyraContextEffectsLibrary.h"
 #include "LyraContextEffectsInterface.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Engine/World.h"
+#include "GameFramework/Character.h"
 #include "LyraContextEffectsSubsystem.h"
 #include "NiagaraFunctionLibrary.h"
 #include "Kismet/GameplayStatics.h"
@@ -13,6 +15,18 @@
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(AnimNotify_LyraContextEffects)
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Context Effect Scene Queries"), STAT_LyraContextEffectSceneQueries, STATGROUP_Game);
+
+namespace LyraContextEffectsCVars
+{
+	static bool bUseCharacterGroundSurface = true;
+	static FAutoConsoleVariableRef CVarUseCharacterGroundSurface(
+		TEXT("Lyra.ContextEffects.UseCharacterGroundSurface"),
+		bUseCharacterGroundSurface,
+		TEXT("Should context effect notifies read the surface from the character's movement component instead of tracing for it?"),
+		ECVF_Default);
+}
+
 
 
 UAnimNotify_LyraContextEffects::UAnimNotify_LyraContextEffects()
@@ -52,6 +66,19 @@ void UAnimNotify_LyraContextEffects::Notify(USkeletalMeshComponent* MeshComp, UA
 		// Make sure both MeshComp and Owning Actor is valid
 		if (AActor* OwningActor = MeshComp->GetOwner())
 		{
+			// Skip the trace and the effects entirely for characters too far from every viewer to notice them
+			if (const UWorld* World = OwningActor->GetWorld())
+			{
+				if (const ULyraContextEffectsSubsystem* LyraContextEffectsSubsystem = World->GetSubsystem<ULyraContextEffectsSubsystem>())
+				{
+					const FVector EffectLocation = bAttached ? MeshComp->GetSocketLocation(SocketName) : MeshComp->GetComponentLocation();
+					if (LyraContextEffectsSubsystem->ShouldCullContextEffects(EffectLocation))
+					{
+						return;
+					}
+				}
+			}
+
 			// Prepare Trace Data
 			bool bHitSuccess = false;
 			FHitResult HitResult;
@@ -66,15 +93,38 @@ void UAnimNotify_LyraContextEffects::Notify(USkeletalMeshComponent* MeshComp, UA
 
 			if (bPerformTrace)
 			{
-				// If trace is needed, set up Start Location to Attached
-				FVector TraceStart = bAttached ? MeshComp->GetSocketLocation(SocketName) : MeshComp->GetComponentLocation();
+				// Reuse the surface the character's movement already found this frame if the trace would reach it
+				bool bUsedGroundSurface = false;
+				if (TraceProperties.bUseCharacterGroundSurface && LyraContextEffectsCVars::bUseCharacterGroundSurface)
+				{
+					if (const ACharacter* OwningCharacter = Cast<ACharacter>(OwningActor))
+					{
+						if (ULyraCharacterMovementComponent* LyraMoveComp = Cast<ULyraCharacterMovementComponent>(OwningCharacter->GetCharacterMovement()))
+						{
+							const FLyraCharacterGroundSurfaceInfo& GroundSurfaceInfo = LyraMoveComp->GetGroundSurfaceInfo();
+							if (GroundSurfaceInfo.bHasSurface && (GroundSurfaceInfo.SurfaceDistance <= TraceProperties.EndTraceLocationOffset.Size()))
+							{
+								HitResult = GroundSurfaceInfo.SurfaceHitResult;
+								bHitSuccess = true;
+								bUsedGroundSurface = true;
+							}
+						}
+					}
+				}
 
-				// Make sure World is valid
-				if (UWorld* World = OwningActor->GetWorld())
+				if (!bUsedGroundSurface)
 				{
-					// Call Line Trace, Pass in relevant properties
-					bHitSuccess = World->LineTraceSingleByChannel(HitResult, TraceStart, (TraceStart + TraceProperties.EndTraceLocationOffset),
-						TraceProperties.TraceChannel, QueryParams, FCollisionResponseParams::DefaultResponseParam);
+					// If trace is needed, set up Start Location to Attached
+					FVector TraceStart = bAttached ? MeshComp->GetSocketLocation(SocketName) : MeshComp->GetComponentLocation();
+
+					// Make sure World is valid
+					if (UWorld* World = OwningActor->GetWorld())
+					{
+						// Call Line Trace, Pass in relevant properties
+						bHitSuccess = World->LineTraceSingleByChannel(HitResult, TraceStart, (TraceStart + TraceProperties.EndTraceLocationOffset),
+							TraceProperties.TraceChannel, QueryParams, FCollisionResponseParams::DefaultResponseParam);
+						INC_DWORD_STAT(STAT_LyraContextEffectSceneQueries);
+					}
 				}
 			}
 
@@ -61,6 +61,10 @@ struct FLyraContextEffectAnimNotifyTraceSettings
 	// Ignore this Actor when getting trace result
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Trace)
 	bool bIgnoreActor = true;
+
+	// Use the ground surface the character's movement component already found (when it is within the trace length) instead of tracing
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Trace)
+	bool bUseCharacterGroundSurface = true;
 };
 
 /**
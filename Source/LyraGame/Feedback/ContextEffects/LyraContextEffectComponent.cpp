@@ -3,8 +3,10 @@
 
 #include "LyraContextEffectComponent.h"
 
+#include "Components/AudioComponent.h"
 #include "Engine/World.h"
 #include "LyraContextEffectsSubsystem.h"
+#include "NiagaraComponent.h"
 #include "PhysicalMaterials/PhysicalMaterial.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraContextEffectComponent)
@@ -99,19 +101,19 @@ void ULyraContextEffectComponent::AnimMotionEffect_Implementation(const FName Bo
 		}
 	}
 
-	// Cycle through Active Audio Components and cache
+	// Cycle through Active Audio Components and cache the ones still playing (finished ones may be reused from the pool)
 	for (UAudioComponent* ActiveAudioComponent : ActiveAudioComponents)
 	{
-		if (ActiveAudioComponent)
+		if (ActiveAudioComponent && ActiveAudioComponent->IsPlaying())
 		{
 			AudioComponentsToAdd.Add(ActiveAudioComponent);
 		}
 	}
 
-	// Cycle through Active Niagara Components and cache
+	// Cycle through Active Niagara Components and cache the ones still active (completed ones go back to the pool)
 	for (UNiagaraComponent* ActiveNiagaraComponent : ActiveNiagaraComponents)
 	{
-		if (ActiveNiagaraComponent)
+		if (ActiveNiagaraComponent && ActiveNiagaraComponent->IsActive())
 		{
 			NiagaraComponentsToAdd.Add(ActiveNiagaraComponent);
 		}
@@ -2,25 +2,159 @@
 
 #include "Feedback/ContextEffects/LyraContextEffectsLibrary.h"
 
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "HAL/IConsoleManager.h"
 #include "NiagaraSystem.h"
 #include "Sound/SoundBase.h"
+#include "UObject/UObjectIterator.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraContextEffectsLibrary)
 
+namespace LyraContextEffectsCVars
+{
+	static bool bAsyncLoading = true;
+	static FAutoConsoleVariableRef CVarAsyncLoading(
+		TEXT("Lyra.ContextEffects.AsyncLoading"),
+		bAsyncLoading,
+		TEXT("Should context effect libraries and their effects be loaded asynchronously (instead of synchronously when first used)?"),
+		ECVF_Default);
+
+	static bool bIndexedLookup = true;
+	static FAutoConsoleVariableRef CVarIndexedLookup(
+		TEXT("Lyra.ContextEffects.IndexedLookup"),
+		bIndexedLookup,
+		TEXT("Should context effect libraries resolve effects through their effect tag index and lookup cache (instead of scanning every effect)?"),
+		ECVF_Default);
+
+	static int32 MaxLookupCacheEntries = 256;
+	static FAutoConsoleVariableRef CVarMaxLookupCacheEntries(
+		TEXT("Lyra.ContextEffects.MaxLookupCacheEntries"),
+		MaxLookupCacheEntries,
+		TEXT("Number of (effect, context) pairs each context effects library caches before the cache is cleared"),
+		ECVF_Default);
+}
+
+DECLARE_CYCLE_STAT(TEXT("ContextEffectsLibrary GetEffects"), STAT_LyraContextEffectsGetEffects, STATGROUP_Game);
+
+FLyraContextEffectsLoadStats& FLyraContextEffectsLoadStats::Get()
+{
+	static FLyraContextEffectsLoadStats Stats;
+	return Stats;
+}
+
+bool FLyraContextEffectsLoadStats::UseAsyncLoading()
+{
+	return LyraContextEffectsCVars::bAsyncLoading;
+}
+
+static FAutoConsoleCommandWithArgsAndOutputDevice ContextEffectsLoadReportCommand(
+	TEXT("Lyra.ContextEffects.LoadReport"),
+	TEXT("Prints how much game thread time was spent loading context effect libraries (pass 'reset' to clear the totals)"),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		FLyraContextEffectsLoadStats& Stats = FLyraContextEffectsLoadStats::Get();
+		Ar.Logf(TEXT("Context effects (%s loading): %d libraries, %d effects, %d async requests, %.2f ms on the game thread (worst %.2f ms)"),
+			FLyraContextEffectsLoadStats::UseAsyncLoading() ? TEXT("async") : TEXT("sync"),
+			Stats.NumLibrariesLoaded, Stats.NumEffectsLoaded, Stats.NumAsyncRequests,
+			Stats.GameThreadLoadSeconds * 1000.0, Stats.WorstGameThreadLoadSeconds * 1000.0);
+
+		if ((Args.Num() > 0) && (Args[0] == TEXT("reset")))
+		{
+			Stats = FLyraContextEffectsLoadStats();
+		}
+	}));
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithArgsAndOutputDevice ContextEffectsLookupBenchmarkCommand(
+	TEXT("Lyra.ContextEffects.LookupBenchmark"),
+	TEXT("Times the effect lookups of every loaded context effects library for a number of characters playing notifies each frame, with a linear scan and with the index. Usage: Lyra.ContextEffects.LookupBenchmark [Characters=64] [Frames=600]"),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		const int32 NumCharacters = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 64;
+		const int32 NumFrames = (Args.Num() > 1) ? FMath::Max(1, FCString::Atoi(*Args[1])) : 600;
+
+		// Replay the (effect, context) pairs the libraries are authored with, as the notifies would request them
+		TArray<ULyraContextEffectsLibrary*> Libraries;
+		TArray<TPair<FGameplayTag, FGameplayTagContainer>> Queries;
+		for (TObjectIterator<ULyraContextEffectsLibrary> It; It; ++It)
+		{
+			if (It->GetContextEffectsLibraryLoadState() == EContextEffectsLibraryLoadState::Loaded)
+			{
+				Libraries.Add(*It);
+				for (const FLyraContextEffects& ContextEffect : It->ContextEffects)
+				{
+					Queries.AddUnique(TPair<FGameplayTag, FGameplayTagContainer>(ContextEffect.EffectTag, ContextEffect.Context));
+				}
+			}
+		}
+
+		if (Queries.Num() == 0)
+		{
+			Ar.Logf(TEXT("No loaded context effects libraries to benchmark"));
+			return;
+		}
+
+		const bool bPreviousIndexedLookup = LyraContextEffectsCVars::bIndexedLookup;
+
+		TArray<USoundBase*> Sounds;
+		TArray<UNiagaraSystem*> NiagaraSystems;
+		auto RunLookups = [&]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				for (int32 Character = 0; Character < NumCharacters; ++Character)
+				{
+					const TPair<FGameplayTag, FGameplayTagContainer>& Query = Queries[(Frame + Character) % Queries.Num()];
+					for (ULyraContextEffectsLibrary* Library : Libraries)
+					{
+						Sounds.Reset();
+						NiagaraSystems.Reset();
+						Library->GetEffects(Query.Key, Query.Value, Sounds, NiagaraSystems);
+					}
+				}
+			}
+			return FPlatformTime::Seconds() - StartTime;
+		};
+
+		LyraContextEffectsCVars::bIndexedLookup = false;
+		const double LinearSeconds = RunLookups();
+		LyraContextEffectsCVars::bIndexedLookup = true;
+		const double IndexedSeconds = RunLookups();
+		LyraContextEffectsCVars::bIndexedLookup = bPreviousIndexedLookup;
+
+		const double NumLookups = (double)NumFrames * NumCharacters * Libraries.Num();
+		Ar.Logf(TEXT("%d characters x %d frames over %d libraries (%d distinct queries)"), NumCharacters, NumFrames, Libraries.Num(), Queries.Num());
+		Ar.Logf(TEXT("  Linear:  %.2f ms total, %.3f us per lookup, %.3f ms per frame"), LinearSeconds * 1000.0, LinearSeconds * 1000000.0 / NumLookups, LinearSeconds * 1000.0 / NumFrames);
+		Ar.Logf(TEXT("  Indexed: %.2f ms total, %.3f us per lookup, %.3f ms per frame"), IndexedSeconds * 1000.0, IndexedSeconds * 1000000.0 / NumLookups, IndexedSeconds * 1000.0 / NumFrames);
+	}));
+#endif // !UE_BUILD_SHIPPING
 
 void ULyraContextEffectsLibrary::GetEffects(const FGameplayTag Effect, const FGameplayTagContainer Context, 
 	TArray<USoundBase*>& Sounds, TArray<UNiagaraSystem*>& NiagaraSystems)
 {
+	SCOPE_CYCLE_COUNTER(STAT_LyraContextEffectsGetEffects);
+
 	// Make sure Effect is valid and Library is loaded
 	if (Effect.IsValid() && Context.IsValid() && EffectsLoadState == EContextEffectsLibraryLoadState::Loaded)
 	{
+		if (LyraContextEffectsCVars::bIndexedLookup)
+		{
+			// Get all Matching Sounds and Niagara Systems
+			for (const int32 ActiveEffectIndex : FindMatchingEffects(Effect, Context))
+			{
+				const ULyraActiveContextEffects* ActiveContextEffect = ActiveContextEffects[ActiveEffectIndex];
+				Sounds.Append(ActiveContextEffect->Sounds);
+				NiagaraSystems.Append(ActiveContextEffect->NiagaraSystems);
+			}
+			return;
+		}
+
 		// Loop through Context Effects
 		for (const auto& ActiveContextEffect : ActiveContextEffects)
 		{
-			// Make sure the Effect is an exact Tag Match and ensure the Context has all tags in the Effect (and neither or both are empty)
-			if (Effect.MatchesTagExact(ActiveContextEffect->EffectTag)
-				&& Context.HasAllExact(ActiveContextEffect->Context)
-				&& (ActiveContextEffect->Context.IsEmpty() == Context.IsEmpty()))
+			if (DoesActiveEffectMatch(*ActiveContextEffect, Effect, Context))
 			{
 				// Get all Matching Sounds and Niagara Systems
 				Sounds.Append(ActiveContextEffect->Sounds);
@@ -30,22 +164,131 @@ void ULyraContextEffectsLibrary::GetEffects(const FGameplayTag Effect, const FGa
 	}
 }
 
+bool ULyraContextEffectsLibrary::DoesActiveEffectMatch(const ULyraActiveContextEffects& ActiveContextEffect, const FGameplayTag& Effect, const FGameplayTagContainer& Context)
+{
+	// Make sure the Effect is an exact Tag Match and ensure the Context has all tags in the Effect (and neither or both are empty)
+	return Effect.MatchesTagExact(ActiveContextEffect.EffectTag)
+		&& Context.HasAllExact(ActiveContextEffect.Context)
+		&& (ActiveContextEffect.Context.IsEmpty() == Context.IsEmpty());
+}
+
+const TArray<int32>& ULyraContextEffectsLibrary::FindMatchingEffects(const FGameplayTag& Effect, const FGameplayTagContainer& Context)
+{
+	FEffectLookupKey Key;
+	Key.Effect = Effect;
+	Key.Context = Context;
+
+	if (const TArray<int32>* CachedMatches = EffectLookupCache.Find(Key))
+	{
+		return *CachedMatches;
+	}
+
+	// Keep the cache bounded, contexts built from many surface and gameplay tags could otherwise grow it forever
+	if (EffectLookupCache.Num() >= LyraContextEffectsCVars::MaxLookupCacheEntries)
+	{
+		EffectLookupCache.Reset();
+	}
+
+	TArray<int32> Matches;
+	if (const TArray<int32>* Candidates = EffectTagIndex.Find(Effect))
+	{
+		for (const int32 ActiveEffectIndex : *Candidates)
+		{
+			if (DoesActiveEffectMatch(*ActiveContextEffects[ActiveEffectIndex], Effect, Context))
+			{
+				Matches.Add(ActiveEffectIndex);
+			}
+		}
+	}
+
+	return EffectLookupCache.Add(MoveTemp(Key), MoveTemp(Matches));
+}
+
+void ULyraContextEffectsLibrary::RebuildEffectIndex()
+{
+	EffectTagIndex.Reset();
+	EffectLookupCache.Reset();
+
+	for (int32 ActiveEffectIndex = 0; ActiveEffectIndex < ActiveContextEffects.Num(); ++ActiveEffectIndex)
+	{
+		const ULyraActiveContextEffects* ActiveContextEffect = ActiveContextEffects[ActiveEffectIndex];
+
+		// Entries without a context can never match a (required) valid context, so they are left out of the index
+		if (ActiveContextEffect && !ActiveContextEffect->Context.IsEmpty())
+		{
+			EffectTagIndex.FindOrAdd(ActiveContextEffect->EffectTag).Add(ActiveEffectIndex);
+		}
+	}
+}
+
 void ULyraContextEffectsLibrary::LoadEffects()
 {
-	// Load Effects into Library if not currently loading
-	if (EffectsLoadState != EContextEffectsLibraryLoadState::Loading)
+	// Load Effects into Library if not already loading or loaded, every component using the library shares them
+	if (EffectsLoadState == EContextEffectsLibraryLoadState::Unloaded)
 	{
 		// Set load state to loading
 		EffectsLoadState = EContextEffectsLibraryLoadState::Loading;
 
 		// Clear out any old Active Effects
 		ActiveContextEffects.Empty();
+		RebuildEffectIndex();
 
 		// Call internal loading function
 		LoadEffectsInternal();
 	}
 }
 
+void ULyraContextEffectsLibrary::GetEffectPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	for (const FLyraContextEffects& ContextEffect : ContextEffects)
+	{
+		for (const FSoftObjectPath& Effect : ContextEffect.Effects)
+		{
+			if (!Effect.IsNull())
+			{
+				OutPaths.AddUnique(Effect);
+			}
+		}
+	}
+}
+
+bool ULyraContextEffectsLibrary::BeginBatchedLoad()
+{
+	if (EffectsLoadState != EContextEffectsLibraryLoadState::Unloaded)
+	{
+		return false;
+	}
+
+	EffectsLoadState = EContextEffectsLibraryLoadState::Loading;
+	ActiveContextEffects.Empty();
+	RebuildEffectIndex();
+	return true;
+}
+
+void ULyraContextEffectsLibrary::FinishLoadingEffects()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<ULyraActiveContextEffects*> ActiveContextEffectsArray = BuildActiveContextEffects(/*bLoadSynchronously=*/ false);
+	EffectsLoadHandle.Reset();
+	LyraContextEffectLibraryLoadingComplete(ActiveContextEffectsArray);
+
+	FLyraContextEffectsLoadStats::Get().AddGameThreadLoadTime(FPlatformTime::Seconds() - StartTime);
+}
+
+#if WITH_EDITOR
+void ULyraContextEffectsLibrary::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Pick up the edited effects the next time the library is used
+	if (EffectsLoadState == EContextEffectsLibraryLoadState::Loaded)
+	{
+		EffectsLoadState = EContextEffectsLibraryLoadState::Unloaded;
+	}
+}
+#endif
+
 EContextEffectsLibraryLoadState ULyraContextEffectsLibrary::GetContextEffectsLibraryLoadState()
 {
 	// Return current Load State
@@ -54,16 +297,38 @@ EContextEffectsLibraryLoadState ULyraContextEffectsLibrary::GetContextEffectsLib
 
 void ULyraContextEffectsLibrary::LoadEffectsInternal()
 {
-	// TODO Add Async Loading for Libraries
+	if (FLyraContextEffectsLoadStats::UseAsyncLoading())
+	{
+		TArray<FSoftObjectPath> EffectPaths;
+		GetEffectPaths(/*out*/ EffectPaths);
 
-	// Copy data for async load
-	TArray<FLyraContextEffects> LocalContextEffects = ContextEffects;
+		if (EffectPaths.Num() > 0)
+		{
+			FLyraContextEffectsLoadStats::Get().NumAsyncRequests++;
+			EffectsLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(EffectPaths, FStreamableDelegate::CreateUObject(this, &ThisClass::FinishLoadingEffects));
+		}
+		else
+		{
+			FinishLoadingEffects();
+		}
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Mark loading complete
+	this->LyraContextEffectLibraryLoadingComplete(BuildActiveContextEffects(/*bLoadSynchronously=*/ true));
+
+	FLyraContextEffectsLoadStats::Get().AddGameThreadLoadTime(FPlatformTime::Seconds() - StartTime);
+}
 
+TArray<ULyraActiveContextEffects*> ULyraContextEffectsLibrary::BuildActiveContextEffects(bool bLoadSynchronously)
+{
 	// Prepare Active Context Effects Array
 	TArray<ULyraActiveContextEffects*> ActiveContextEffectsArray;
 
 	// Loop through Context Effects
-	for (const FLyraContextEffects& ContextEffect : LocalContextEffects)
+	for (const FLyraContextEffects& ContextEffect : ContextEffects)
 	{
 		// Make sure Tags are Valid
 		if (ContextEffect.EffectTag.IsValid() && ContextEffect.Context.IsValid())
@@ -75,11 +340,13 @@ void ULyraContextEffectsLibrary::LoadEffectsInternal()
 			NewActiveContextEffects->EffectTag = ContextEffect.EffectTag;
 			NewActiveContextEffects->Context = ContextEffect.Context;
 
-			// Try to load and add Effects to New Active Context Effects
+			// Try to load (or find, when they were loaded asynchronously) and add Effects to New Active Context Effects
 			for (const FSoftObjectPath& Effect : ContextEffect.Effects)
 			{
-				if (UObject* Object = Effect.TryLoad())
+				if (UObject* Object = bLoadSynchronously ? Effect.TryLoad() : Effect.ResolveObject())
 				{
+					FLyraContextEffectsLoadStats::Get().NumEffectsLoaded++;
+
 					if (Object->IsA(USoundBase::StaticClass()))
 					{
 						if (USoundBase* SoundBase = Cast<USoundBase>(Object))
@@ -102,9 +369,7 @@ void ULyraContextEffectsLibrary::LoadEffectsInternal()
 		}
 	}
 
-	// TODO Call Load Complete after Async Load
-	// Mark loading complete
-	this->LyraContextEffectLibraryLoadingComplete(ActiveContextEffectsArray);
+	return ActiveContextEffectsArray;
 }
 
 void ULyraContextEffectsLibrary::LyraContextEffectLibraryLoadingComplete(
@@ -112,8 +377,11 @@ void ULyraContextEffectsLibrary::LyraContextEffectLibraryLoadingComplete(
 {
 	// Flag data as loaded
 	EffectsLoadState = EContextEffectsLibraryLoadState::Loaded;
+	FLyraContextEffectsLoadStats::Get().NumLibrariesLoaded++;
 
 	// Append incoming Context Effects Array to current list of Active Context Effects
 	ActiveContextEffects.Append(LyraActiveContextEffects);
+
+	RebuildEffectIndex();
 }
 
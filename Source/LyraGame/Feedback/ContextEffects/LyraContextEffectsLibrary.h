@@ -13,6 +13,29 @@
 class UNiagaraSystem;
 class USoundBase;
 struct FFrame;
+struct FStreamableHandle;
+
+/** Totals for the context effects load report (Lyra.ContextEffects.LoadReport) */
+struct FLyraContextEffectsLoadStats
+{
+	/** Time spent on the game thread loading libraries and their effects, or building them once loaded */
+	double GameThreadLoadSeconds = 0.0;
+	double WorstGameThreadLoadSeconds = 0.0;
+	int32 NumLibrariesLoaded = 0;
+	int32 NumEffectsLoaded = 0;
+	int32 NumAsyncRequests = 0;
+
+	void AddGameThreadLoadTime(double Seconds)
+	{
+		GameThreadLoadSeconds += Seconds;
+		WorstGameThreadLoadSeconds = FMath::Max(WorstGameThreadLoadSeconds, Seconds);
+	}
+
+	static UE_API FLyraContextEffectsLoadStats& Get();
+
+	/** Should libraries and effects be loaded asynchronously (Lyra.ContextEffects.AsyncLoading)? */
+	static UE_API bool UseAsyncLoading();
+};
 
 /**
  *
@@ -88,9 +111,39 @@ public:
 
 	UE_API EContextEffectsLibraryLoadState GetContextEffectsLibraryLoadState();
 
+	/** Adds the paths of every effect in the library to OutPaths */
+	UE_API void GetEffectPaths(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/**
+	 * Marks the library as loading for a batched load issued by the caller (see ULyraContextEffectsSubsystem),
+	 * which calls FinishLoadingEffects once the effect paths are loaded. Returns false if it is already loading or loaded.
+	 */
+	UE_API bool BeginBatchedLoad();
+
+	/** Builds the active effects from the loaded effect paths and marks the library as loaded */
+	UE_API void FinishLoadingEffects();
+
+#if WITH_EDITOR
+	//~UObject interface
+	UE_API virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	//~End of UObject interface
+#endif
+
 private:
 	void LoadEffectsInternal();
 
+	/** Creates the active effects, loading the effects synchronously or expecting them to be loaded already */
+	TArray<ULyraActiveContextEffects*> BuildActiveContextEffects(bool bLoadSynchronously);
+
+	/** Returns the indices of the active effects matching the effect and context, from the lookup cache when possible */
+	const TArray<int32>& FindMatchingEffects(const FGameplayTag& Effect, const FGameplayTagContainer& Context);
+
+	/** Returns true if the active effect should be played for the effect and context */
+	static bool DoesActiveEffectMatch(const ULyraActiveContextEffects& ActiveContextEffect, const FGameplayTag& Effect, const FGameplayTagContainer& Context);
+
+	/** Rebuilds the effect tag index, and clears the lookup cache, after the active effects change */
+	void RebuildEffectIndex();
+
 	void LyraContextEffectLibraryLoadingComplete(TArray<ULyraActiveContextEffects*> LyraActiveContextEffects);
 
 	UPROPERTY(Transient)
@@ -98,6 +151,38 @@ private:
 
 	UPROPERTY(Transient)
 	EContextEffectsLibraryLoadState EffectsLoadState = EContextEffectsLibraryLoadState::Unloaded;
+
+	/** Handle for the effects while they are loaded asynchronously by LoadEffects */
+	TSharedPtr<FStreamableHandle> EffectsLoadHandle;
+
+	/** Key of the lookup cache, the effect tag plus the context container it was requested with */
+	struct FEffectLookupKey
+	{
+		FGameplayTag Effect;
+		FGameplayTagContainer Context;
+
+		bool operator==(const FEffectLookupKey& Other) const
+		{
+			return (Effect == Other.Effect) && (Context == Other.Context);
+		}
+
+		friend uint32 GetTypeHash(const FEffectLookupKey& Key)
+		{
+			// Order independent to match operator== (container equality ignores tag order)
+			uint32 ContextHash = 0;
+			for (const FGameplayTag& Tag : Key.Context)
+			{
+				ContextHash += GetTypeHash(Tag);
+			}
+			return HashCombineFast(GetTypeHash(Key.Effect), ContextHash);
+		}
+	};
+
+	/** Indices of the active effects that can match each effect tag (exact match, entries without a context never match) */
+	TMap<FGameplayTag, TArray<int32>> EffectTagIndex;
+
+	/** Resolved active effect indices per (effect, context) pair, footsteps and other notifies repeat the same few pairs */
+	TMap<FEffectLookupKey, TArray<int32>> EffectLookupCache;
 };
 
 #undef UE_API
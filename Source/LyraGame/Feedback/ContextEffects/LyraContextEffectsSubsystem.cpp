@@ -3,11 +3,18 @@
 
 #include "LyraContextEffectsSubsystem.h"
 
+#include "Components/AudioComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
 #include "Feedback/ContextEffects/LyraContextEffectsLibrary.h"
 #include "Feedback/ContextEffects/LyraContextEffectsSubsystem.h"
 #include "Kismet/GameplayStatics.h"
+#include "TimerManager.h"
 #include "NiagaraFunctionLibrary.h"
 #include "NiagaraSystem.h"
+#include "SignificanceManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraContextEffectsSubsystem)
 
@@ -17,6 +24,34 @@ class UNiagaraSystem;
 class USceneComponent;
 class USoundBase;
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Context Effects Culled"), STAT_LyraContextEffectsCulled, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Context Effect Sounds Reused"), STAT_LyraContextEffectSoundsReused, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Context Effect Sounds Spawned"), STAT_LyraContextEffectSoundsSpawned, STATGROUP_Game);
+
+namespace LyraContextEffectsCVars
+{
+	static float CullDistance = 5000.0f;
+	static FAutoConsoleVariableRef CVarCullDistance(
+		TEXT("Lyra.ContextEffects.CullDistance"),
+		CullDistance,
+		TEXT("Context effects further than this from every viewpoint are skipped, including the trace done by the anim notify (0 disables culling)"),
+		ECVF_Default);
+
+	static int32 MaxPooledAudioComponentsPerActor = 4;
+	static FAutoConsoleVariableRef CVarMaxPooledAudioComponentsPerActor(
+		TEXT("Lyra.ContextEffects.MaxPooledAudioComponentsPerActor"),
+		MaxPooledAudioComponentsPerActor,
+		TEXT("Number of audio components each actor keeps for reuse by its context effects, sounds beyond that spawn a component that is destroyed when finished (0 disables pooling)"),
+		ECVF_Default);
+
+	static bool bPoolNiagaraComponents = true;
+	static FAutoConsoleVariableRef CVarPoolNiagaraComponents(
+		TEXT("Lyra.ContextEffects.PoolNiagaraComponents"),
+		bPoolNiagaraComponents,
+		TEXT("Should context effects spawn Niagara systems from the component pool (auto released when complete)?"),
+		ECVF_Default);
+}
+
 void ULyraContextEffectsSubsystem::SpawnContextEffects(
 	const AActor* SpawningActor
 	, USceneComponent* AttachToComponent
@@ -37,6 +72,13 @@ void ULyraContextEffectsSubsystem::SpawnContextEffects(
 		// Validate the pointers from the Map Find
 		if (ULyraContextEffectsSet* EffectsLibraries = *EffectsLibrariesSetPtr)
 		{
+			// Skip cosmetic effects for actors nobody is close enough to notice
+			if (AttachToComponent && ShouldCullContextEffects(AttachToComponent->GetSocketLocation(AttachPoint)))
+			{
+				INC_DWORD_STAT(STAT_LyraContextEffectsCulled);
+				return;
+			}
+
 			// Prepare Arrays for Sounds and Niagara Systems
 			TArray<USoundBase*> TotalSounds;
 			TArray<UNiagaraSystem*> TotalNiagaraSystems;
@@ -68,24 +110,152 @@ void ULyraContextEffectsSubsystem::SpawnContextEffects(
 			// Cycle through found Sounds
 			for (USoundBase* Sound : TotalSounds)
 			{
-				// Spawn Sounds Attached, add Audio Component to List of ACs
-				UAudioComponent* AudioComponent = UGameplayStatics::SpawnSoundAttached(Sound, AttachToComponent, AttachPoint, LocationOffset, RotationOffset, EAttachLocation::KeepRelativeOffset,
-					false, AudioVolume, AudioPitch, 0.0f, nullptr, nullptr, true);
-
-				AudioOut.Add(AudioComponent);
+				// Play Sounds Attached from the actor's pool, add Audio Component to List of ACs
+				if (UAudioComponent* AudioComponent = PlayPooledSound(EffectsLibraries, Sound, AttachToComponent, AttachPoint, LocationOffset, RotationOffset, AudioVolume, AudioPitch))
+				{
+					AudioOut.Add(AudioComponent);
+				}
 			}
 
 			// Cycle through found Niagara Systems
 			for (UNiagaraSystem* NiagaraSystem : TotalNiagaraSystems)
 			{
-				// Spawn Niagara Systems Attached, add Niagara Component to List of NCs
-				UNiagaraComponent* NiagaraComponent = UNiagaraFunctionLibrary::SpawnSystemAttached(NiagaraSystem, AttachToComponent, AttachPoint, LocationOffset,
-					RotationOffset, VFXScale, EAttachLocation::KeepRelativeOffset, true, ENCPoolMethod::None, true, true);
+				// Spawn Niagara Systems Attached (from the world's component pool), add Niagara Component to List of NCs
+				const ENCPoolMethod PoolMethod = LyraContextEffectsCVars::bPoolNiagaraComponents ? ENCPoolMethod::AutoRelease : ENCPoolMethod::None;
+				if (UNiagaraComponent* NiagaraComponent = UNiagaraFunctionLibrary::SpawnSystemAttached(NiagaraSystem, AttachToComponent, AttachPoint, LocationOffset,
+					RotationOffset, VFXScale, EAttachLocation::KeepRelativeOffset, true, PoolMethod, true, true))
+				{
+					NiagaraOut.Add(NiagaraComponent);
+				}
+			}
+		}
+	}
+}
+
+UAudioComponent* ULyraContextEffectsSubsystem::PlayPooledSound(ULyraContextEffectsSet* EffectsLibrariesSet, USoundBase* Sound, USceneComponent* AttachToComponent, const FName AttachPoint,
+	const FVector& LocationOffset, const FRotator& RotationOffset, float AudioVolume, float AudioPitch)
+{
+	TArray<TObjectPtr<UAudioComponent>>& AudioComponentPool = EffectsLibrariesSet->AudioComponentPool;
+	AudioComponentPool.RemoveAll([](const UAudioComponent* AudioComponent) { return !IsValid(AudioComponent); });
+
+	// Reuse a pooled component that finished playing
+	if (AttachToComponent)
+	{
+		for (UAudioComponent* AudioComponent : AudioComponentPool)
+		{
+			if (!AudioComponent->IsPlaying())
+			{
+				if ((AudioComponent->GetAttachParent() != AttachToComponent) || (AudioComponent->GetAttachSocketName() != AttachPoint))
+				{
+					AudioComponent->AttachToComponent(AttachToComponent, FAttachmentTransformRules::KeepRelativeTransform, AttachPoint);
+				}
+				AudioComponent->SetRelativeLocationAndRotation(LocationOffset, RotationOffset);
+				AudioComponent->SetSound(Sound);
+				AudioComponent->SetVolumeMultiplier(AudioVolume);
+				AudioComponent->SetPitchMultiplier(AudioPitch);
+				AudioComponent->Play();
 
-				NiagaraOut.Add(NiagaraComponent);
+				INC_DWORD_STAT(STAT_LyraContextEffectSoundsReused);
+				return AudioComponent;
 			}
 		}
 	}
+
+	// Spawn a new component, pooled ones stay around instead of being destroyed when their sound finishes
+	const bool bAddToPool = (AudioComponentPool.Num() < LyraContextEffectsCVars::MaxPooledAudioComponentsPerActor);
+	UAudioComponent* AudioComponent = UGameplayStatics::SpawnSoundAttached(Sound, AttachToComponent, AttachPoint, LocationOffset, RotationOffset, EAttachLocation::KeepRelativeOffset,
+		false, AudioVolume, AudioPitch, 0.0f, nullptr, nullptr, /*bAutoDestroy=*/ !bAddToPool);
+
+	if (AudioComponent)
+	{
+		INC_DWORD_STAT(STAT_LyraContextEffectSoundsSpawned);
+		if (bAddToPool)
+		{
+			AudioComponentPool.Add(AudioComponent);
+		}
+	}
+
+	return AudioComponent;
+}
+
+void ULyraContextEffectsSubsystem::ReleaseAudioComponentPool(ULyraContextEffectsSet* EffectsLibrariesSet)
+{
+	if (EffectsLibrariesSet == nullptr)
+	{
+		return;
+	}
+
+	for (UAudioComponent* AudioComponent : EffectsLibrariesSet->AudioComponentPool)
+	{
+		if (IsValid(AudioComponent))
+		{
+			// Let sounds that are still playing finish before the component goes away
+			if (AudioComponent->IsPlaying())
+			{
+				AudioComponent->bAutoDestroy = true;
+			}
+			else
+			{
+				AudioComponent->DestroyComponent();
+			}
+		}
+	}
+
+	EffectsLibrariesSet->AudioComponentPool.Reset();
+}
+
+bool ULyraContextEffectsSubsystem::ShouldCullContextEffects(const FVector& Location) const
+{
+	const float CullDistance = LyraContextEffectsCVars::CullDistance;
+	if (CullDistance <= 0.0f)
+	{
+		return false;
+	}
+
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return false;
+	}
+
+	// Use the viewpoints the significance manager was last updated with, or the local players' views when it has none
+	TArray<FTransform, TInlineAllocator<4>> Viewpoints;
+	if (const USignificanceManager* SignificanceManager = USignificanceManager::Get(World))
+	{
+		Viewpoints.Append(SignificanceManager->GetViewpoints());
+	}
+
+	if (Viewpoints.Num() == 0)
+	{
+		for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator)
+		{
+			const APlayerController* PlayerController = Iterator->Get();
+			if (PlayerController && PlayerController->IsLocalController())
+			{
+				FVector ViewLocation;
+				FRotator ViewRotation;
+				PlayerController->GetPlayerViewPoint(/*out*/ ViewLocation, /*out*/ ViewRotation);
+				Viewpoints.Emplace(ViewRotation, ViewLocation);
+			}
+		}
+	}
+
+	// Nothing is viewing (e.g., dedicated server or preview worlds), keep the previous behavior
+	if (Viewpoints.Num() == 0)
+	{
+		return false;
+	}
+
+	const double CullDistanceSquared = FMath::Square((double)CullDistance);
+	for (const FTransform& Viewpoint : Viewpoints)
+	{
+		if (FVector::DistSquared(Viewpoint.GetLocation(), Location) <= CullDistanceSquared)
+		{
+			return false;
+		}
+	}
+
+	return true;
 }
 
 bool ULyraContextEffectsSubsystem::GetContextFromSurfaceType(
@@ -117,18 +287,68 @@ void ULyraContextEffectsSubsystem::LoadAndAddContextEffectsLibraries(AActor* Own
 	// Create new Context Effect Set
 	ULyraContextEffectsSet* EffectsLibrariesSet = NewObject<ULyraContextEffectsSet>(this);
 
-	// Cycle through Libraries getting Soft Obj Refs
-	for (const TSoftObjectPtr<ULyraContextEffectsLibrary>& ContextEffectSoftObj : ContextEffectsLibraries)
+	if (!FLyraContextEffectsLoadStats::UseAsyncLoading())
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		// Cycle through Libraries getting Soft Obj Refs
+		for (const TSoftObjectPtr<ULyraContextEffectsLibrary>& ContextEffectSoftObj : ContextEffectsLibraries)
+		{
+			// Load Library Assets from Soft Obj refs
+			if (ULyraContextEffectsLibrary* EffectsLibrary = ContextEffectSoftObj.LoadSynchronous())
+			{
+				// Call load on valid Libraries
+				EffectsLibrary->LoadEffects();
+
+				// Add new library to Set
+				EffectsLibrariesSet->LyraContextEffectsLibraries.Add(EffectsLibrary);
+			}
+		}
+
+		FLyraContextEffectsLoadStats::Get().AddGameThreadLoadTime(FPlatformTime::Seconds() - StartTime);
+	}
+	else
 	{
-		// Load Library Assets from Soft Obj refs
-		// TODO Support Async Loading of Asset Data
-		if (ULyraContextEffectsLibrary* EffectsLibrary = ContextEffectSoftObj.LoadSynchronous())
+		// Libraries that are already in memory (e.g., shared with another actor) are added right away,
+		// the rest are queued and loaded together with the libraries requested by other actors this frame
+		FPendingLibraryLoad PendingLoad;
+		PendingLoad.OwningActor = OwningActor;
+		PendingLoad.EffectsLibrariesSet = EffectsLibrariesSet;
+
+		TArray<ULyraContextEffectsLibrary*> LoadedLibraries;
+		for (const TSoftObjectPtr<ULyraContextEffectsLibrary>& ContextEffectSoftObj : ContextEffectsLibraries)
+		{
+			if (ULyraContextEffectsLibrary* EffectsLibrary = ContextEffectSoftObj.Get())
+			{
+				EffectsLibrariesSet->LyraContextEffectsLibraries.Add(EffectsLibrary);
+				LoadedLibraries.Add(EffectsLibrary);
+			}
+			else if (!ContextEffectSoftObj.IsNull())
+			{
+				PendingLoad.Libraries.Add(ContextEffectSoftObj);
+			}
+		}
+
+		LoadLibraryEffects(LoadedLibraries);
+
+		if (PendingLoad.Libraries.Num() > 0)
 		{
-			// Call load on valid Libraries
-			EffectsLibrary->LoadEffects();
+			PendingLibraryLoads.Add(MoveTemp(PendingLoad));
 
-			// Add new library to Set
-			EffectsLibrariesSet->LyraContextEffectsLibraries.Add(EffectsLibrary);
+			UWorld* World = GetWorld();
+			if (World && !FlushPendingLibraryLoadsTimerHandle.IsValid())
+			{
+				FlushPendingLibraryLoadsTimerHandle = World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::FlushPendingLibraryLoads);
+			}
+		}
+	}
+
+	// Keep the audio components pooled for the actor when its libraries change
+	if (TObjectPtr<ULyraContextEffectsSet>* PreviousSetPtr = ActiveActorEffectsMap.Find(OwningActor))
+	{
+		if (ULyraContextEffectsSet* PreviousSet = *PreviousSetPtr)
+		{
+			EffectsLibrariesSet->AudioComponentPool = MoveTemp(PreviousSet->AudioComponentPool);
 		}
 	}
 
@@ -136,6 +356,124 @@ void ULyraContextEffectsSubsystem::LoadAndAddContextEffectsLibraries(AActor* Own
 	ActiveActorEffectsMap.Emplace(OwningActor, EffectsLibrariesSet);
 }
 
+void ULyraContextEffectsSubsystem::FlushPendingLibraryLoads()
+{
+	FlushPendingLibraryLoadsTimerHandle.Invalidate();
+
+	if (PendingLibraryLoads.Num() == 0)
+	{
+		return;
+	}
+
+	// Request every library once, even when several actors share it
+	TArray<FSoftObjectPath> LibraryPaths;
+	for (const FPendingLibraryLoad& PendingLoad : PendingLibraryLoads)
+	{
+		for (const TSoftObjectPtr<ULyraContextEffectsLibrary>& Library : PendingLoad.Libraries)
+		{
+			LibraryPaths.AddUnique(Library.ToSoftObjectPath());
+		}
+	}
+
+	PruneLoadHandles();
+
+	FLyraContextEffectsLoadStats::Get().NumAsyncRequests++;
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(LibraryPaths,
+		FStreamableDelegate::CreateUObject(this, &ThisClass::OnLibrariesLoaded, MoveTemp(PendingLibraryLoads)));
+	PendingLibraryLoads.Reset();
+
+	if (Handle.IsValid())
+	{
+		LoadHandles.Add(Handle);
+	}
+}
+
+void ULyraContextEffectsSubsystem::OnLibrariesLoaded(TArray<FPendingLibraryLoad> LoadedRequests)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<ULyraContextEffectsLibrary*> LoadedLibraries;
+	for (const FPendingLibraryLoad& LoadedRequest : LoadedRequests)
+	{
+		// The actor may have been removed (or have requested a new set) while its libraries were loading
+		ULyraContextEffectsSet* EffectsLibrariesSet = LoadedRequest.EffectsLibrariesSet.Get();
+		const TObjectPtr<ULyraContextEffectsSet>* ActiveSet = ActiveActorEffectsMap.Find(LoadedRequest.OwningActor.Get());
+		const bool bSetStillActive = (EffectsLibrariesSet != nullptr) && (ActiveSet != nullptr) && (*ActiveSet == EffectsLibrariesSet);
+
+		for (const TSoftObjectPtr<ULyraContextEffectsLibrary>& Library : LoadedRequest.Libraries)
+		{
+			if (ULyraContextEffectsLibrary* EffectsLibrary = Library.Get())
+			{
+				if (bSetStillActive)
+				{
+					EffectsLibrariesSet->LyraContextEffectsLibraries.Add(EffectsLibrary);
+				}
+				LoadedLibraries.AddUnique(EffectsLibrary);
+			}
+		}
+	}
+
+	FLyraContextEffectsLoadStats::Get().AddGameThreadLoadTime(FPlatformTime::Seconds() - StartTime);
+
+	LoadLibraryEffects(LoadedLibraries);
+}
+
+void ULyraContextEffectsSubsystem::LoadLibraryEffects(const TArray<ULyraContextEffectsLibrary*>& Libraries)
+{
+	// Gather the effects of every library that hasn't been loaded yet into one request
+	TArray<FSoftObjectPath> EffectPaths;
+	TArray<TWeakObjectPtr<ULyraContextEffectsLibrary>> LoadingLibraries;
+	for (ULyraContextEffectsLibrary* EffectsLibrary : Libraries)
+	{
+		if (EffectsLibrary && EffectsLibrary->BeginBatchedLoad())
+		{
+			EffectsLibrary->GetEffectPaths(/*out*/ EffectPaths);
+			LoadingLibraries.Add(EffectsLibrary);
+		}
+	}
+
+	if (LoadingLibraries.Num() == 0)
+	{
+		return;
+	}
+
+	if (EffectPaths.Num() == 0)
+	{
+		OnLibraryEffectsLoaded(MoveTemp(LoadingLibraries));
+		return;
+	}
+
+	PruneLoadHandles();
+
+	FLyraContextEffectsLoadStats::Get().NumAsyncRequests++;
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(EffectPaths,
+		FStreamableDelegate::CreateUObject(this, &ThisClass::OnLibraryEffectsLoaded, MoveTemp(LoadingLibraries)));
+
+	if (Handle.IsValid())
+	{
+		LoadHandles.Add(Handle);
+	}
+}
+
+void ULyraContextEffectsSubsystem::OnLibraryEffectsLoaded(TArray<TWeakObjectPtr<ULyraContextEffectsLibrary>> Libraries)
+{
+	for (const TWeakObjectPtr<ULyraContextEffectsLibrary>& LibraryPtr : Libraries)
+	{
+		if (ULyraContextEffectsLibrary* EffectsLibrary = LibraryPtr.Get())
+		{
+			EffectsLibrary->FinishLoadingEffects();
+		}
+	}
+}
+
+void ULyraContextEffectsSubsystem::PruneLoadHandles()
+{
+	LoadHandles.RemoveAll([](const TSharedPtr<FStreamableHandle>& Handle)
+	{
+		return !Handle.IsValid() || Handle->HasLoadCompleted() || Handle->WasCanceled();
+	});
+}
+
 void ULyraContextEffectsSubsystem::UnloadAndRemoveContextEffectsLibraries(AActor* OwningActor)
 {
 	// Early out if Owning Actor is invalid
@@ -144,7 +482,11 @@ void ULyraContextEffectsSubsystem::UnloadAndRemoveContextEffectsLibraries(AActor
 		return;
 	}
 
-	// Remove ref from Active Actor/Effects Set Map
-	ActiveActorEffectsMap.Remove(OwningActor);
+	// Release the pooled audio components and remove ref from Active Actor/Effects Set Map
+	TObjectPtr<ULyraContextEffectsSet> EffectsLibrariesSet;
+	if (ActiveActorEffectsMap.RemoveAndCopyValue(OwningActor, /*out*/ EffectsLibrariesSet))
+	{
+		ReleaseAudioComponentPool(EffectsLibrariesSet);
+	}
 }
 
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Engine/DeveloperSettings.h"
+#include "Engine/TimerHandle.h"
 #include "GameplayTagContainer.h"
 #include "Subsystems/WorldSubsystem.h"
 
@@ -20,6 +21,7 @@ class USceneComponent;
 struct FFrame;
 struct FGameplayTag;
 struct FGameplayTagContainer;
+struct FStreamableHandle;
 
 /**
  *
@@ -46,6 +48,10 @@ class ULyraContextEffectsSet : public UObject
 public:
 	UPROPERTY(Transient)
 	TSet<TObjectPtr<ULyraContextEffectsLibrary>> LyraContextEffectsLibraries;
+
+	/** Audio components spawned for the owning actor that are reused once their sound finishes */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UAudioComponent>> AudioComponentPool;
 };
 
 
@@ -74,6 +80,10 @@ public:
 		, float AudioVolume = 1
 		, float AudioPitch = 1);
 
+	/** Returns true if context effects at Location are too far from every viewer to be worth playing */
+	UFUNCTION(BlueprintCallable, Category = "ContextEffects")
+	UE_API bool ShouldCullContextEffects(const FVector& Location) const;
+
 	/** */
 	UFUNCTION(BlueprintCallable, Category = "ContextEffects")
 	UE_API bool GetContextFromSurfaceType(TEnumAsByte<EPhysicalSurface> PhysicalSurface, FGameplayTag& Context);
@@ -86,11 +96,48 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "ContextEffects")
 	UE_API void UnloadAndRemoveContextEffectsLibraries(AActor* OwningActor);
 
+private:
+	/** Plays the sound from a pooled audio component of the effects set, spawning (and pooling) a new one if none is free */
+	UAudioComponent* PlayPooledSound(ULyraContextEffectsSet* EffectsLibrariesSet, USoundBase* Sound, USceneComponent* AttachToComponent, const FName AttachPoint,
+		const FVector& LocationOffset, const FRotator& RotationOffset, float AudioVolume, float AudioPitch);
+
+	/** Stops and destroys the pooled audio components of an effects set that is no longer used */
+	void ReleaseAudioComponentPool(ULyraContextEffectsSet* EffectsLibrariesSet);
+
+	/** Libraries requested by an actor that were not loaded yet, added to its set once the batched load completes */
+	struct FPendingLibraryLoad
+	{
+		TWeakObjectPtr<AActor> OwningActor;
+		TWeakObjectPtr<ULyraContextEffectsSet> EffectsLibrariesSet;
+		TArray<TSoftObjectPtr<ULyraContextEffectsLibrary>> Libraries;
+	};
+
+	/** Issues one async load for every library requested since the last flush */
+	void FlushPendingLibraryLoads();
+
+	/** Called when a batch of libraries is loaded, then loads the effects of the new libraries in one more batch */
+	void OnLibrariesLoaded(TArray<FPendingLibraryLoad> LoadedRequests);
+
+	/** Called when the effects of a batch of libraries are loaded */
+	void OnLibraryEffectsLoaded(TArray<TWeakObjectPtr<ULyraContextEffectsLibrary>> Libraries);
+
+	/** Starts the batched load of the effects of every library that has not been loaded yet */
+	void LoadLibraryEffects(const TArray<ULyraContextEffectsLibrary*>& Libraries);
+
+	/** Drops the handles of loads that have finished */
+	void PruneLoadHandles();
+
 private:
 
 	UPROPERTY(Transient)
 	TMap<TObjectPtr<AActor>, TObjectPtr<ULyraContextEffectsSet>> ActiveActorEffectsMap;
 
+	TArray<FPendingLibraryLoad> PendingLibraryLoads;
+
+	TArray<TSharedPtr<FStreamableHandle>> LoadHandles;
+
+	FTimerHandle FlushPendingLibraryLoadsTimerHandle;
+
 };
 
 #undef UE_API
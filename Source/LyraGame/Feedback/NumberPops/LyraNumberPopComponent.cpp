@@ -2,10 +2,166 @@
 
 #include "LyraNumberPopComponent.h"
 
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraNumberPopComponent)
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Number Pops Requested"), STAT_LyraNumberPopsRequested, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Number Pops Merged"), STAT_LyraNumberPopsMerged, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Number Pops Displayed"), STAT_LyraNumberPopsDisplayed, STATGROUP_Game);
+
+namespace LyraNumberPopCVars
+{
+	static bool bAggregateNumberPops = true;
+	static FAutoConsoleVariableRef CVarAggregateNumberPops(
+		TEXT("Lyra.NumberPops.Aggregate"),
+		bAggregateNumberPops,
+		TEXT("Should number pop requests for the same target be merged together (instead of each being displayed)?"),
+		ECVF_Default);
+}
+
 ULyraNumberPopComponent::ULyraNumberPopComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 }
 
+void ULyraNumberPopComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(FlushTimerHandle);
+	}
+	PendingNumberPops.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+ULyraNumberPopComponent::FAggregationKey ULyraNumberPopComponent::MakeAggregationKey(const FLyraNumberPopRequest& Request) const
+{
+	if (Request.TargetActor != nullptr)
+	{
+		return FAggregationKey(FObjectKey(Request.TargetActor), FIntVector::ZeroValue);
+	}
+
+	const float CellSize = FMath::Max(LocationMergeCellSize, 1.0f);
+	return FAggregationKey(FObjectKey(), FIntVector(
+		FMath::FloorToInt32(Request.WorldLocation.X / CellSize),
+		FMath::FloorToInt32(Request.WorldLocation.Y / CellSize),
+		FMath::FloorToInt32(Request.WorldLocation.Z / CellSize)));
+}
+
+void ULyraNumberPopComponent::AddNumberPop(const FLyraNumberPopRequest& NewRequest)
+{
+	INC_DWORD_STAT(STAT_LyraNumberPopsRequested);
+
+	UWorld* World = GetWorld();
+	if (!LyraNumberPopCVars::bAggregateNumberPops || (World == nullptr))
+	{
+		INC_DWORD_STAT(STAT_LyraNumberPopsDisplayed);
+		DisplayNumberPop(NewRequest);
+		return;
+	}
+
+	// Requests without a target are only merged by location when that is enabled, otherwise nearby targets would be summed together
+	if ((NewRequest.TargetActor == nullptr) && (LocationMergeCellSize <= 0.0f))
+	{
+		INC_DWORD_STAT(STAT_LyraNumberPopsDisplayed);
+		DisplayNumberPop(NewRequest);
+		return;
+	}
+
+	FLyraPendingNumberPop& Pending = PendingNumberPops.FindOrAdd(MakeAggregationKey(NewRequest));
+	if (Pending.bHasRequest)
+	{
+		// Merge into the pop that is waiting for this target
+		INC_DWORD_STAT(STAT_LyraNumberPopsMerged);
+		Pending.Request.NumberToDisplay += NewRequest.NumberToDisplay;
+		Pending.Request.bIsCriticalDamage |= NewRequest.bIsCriticalDamage;
+		Pending.Request.WorldLocation = NewRequest.WorldLocation;
+		Pending.Request.SourceTags.AppendTags(NewRequest.SourceTags);
+		Pending.Request.TargetTags.AppendTags(NewRequest.TargetTags);
+		return;
+	}
+
+	const float DisplayDelay = FMath::Max(AggregationWindow, 0.0f);
+	Pending.Request = NewRequest;
+	Pending.DisplayTime = World->GetTimeSeconds() + DisplayDelay;
+	Pending.bHasRequest = true;
+
+	// The timer may be waiting on a pop that is still showing (up to ConcurrentPopDuration away), bring it forward for this one
+	FTimerManager& TimerManager = World->GetTimerManager();
+	const bool bTimerTooLate = !TimerManager.IsTimerActive(FlushTimerHandle) || (TimerManager.GetTimerRemaining(FlushTimerHandle) > (DisplayDelay + UE_KINDA_SMALL_NUMBER));
+	if (bTimerTooLate)
+	{
+		if (DisplayDelay > 0.0f)
+		{
+			TimerManager.SetTimer(FlushTimerHandle, this, &ThisClass::FlushPendingNumberPops, DisplayDelay);
+		}
+		else
+		{
+			TimerManager.ClearTimer(FlushTimerHandle);
+			FlushTimerHandle = TimerManager.SetTimerForNextTick(this, &ThisClass::FlushPendingNumberPops);
+		}
+	}
+}
+
+void ULyraNumberPopComponent::FlushPendingNumberPops()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	const double CurrentTime = World->GetTimeSeconds();
+	double NextFlushTime = TNumericLimits<double>::Max();
+
+	for (auto It = PendingNumberPops.CreateIterator(); It; ++It)
+	{
+		FLyraPendingNumberPop& Pending = It.Value();
+
+		Pending.ActivePopEndTimes.RemoveAll([CurrentTime](double EndTime) { return EndTime <= CurrentTime; });
+
+		if (!Pending.bHasRequest)
+		{
+			if (Pending.ActivePopEndTimes.Num() == 0)
+			{
+				It.RemoveCurrent();
+			}
+			else
+			{
+				NextFlushTime = FMath::Min(NextFlushTime, Pending.ActivePopEndTimes[0]);
+			}
+			continue;
+		}
+
+		if (CurrentTime < Pending.DisplayTime)
+		{
+			NextFlushTime = FMath::Min(NextFlushTime, Pending.DisplayTime);
+			continue;
+		}
+
+		// Too many pops showing for this target already, keep adding to this one until the oldest finishes
+		if ((MaxConcurrentPopsPerTarget > 0) && (Pending.ActivePopEndTimes.Num() >= MaxConcurrentPopsPerTarget))
+		{
+			NextFlushTime = FMath::Min(NextFlushTime, Pending.ActivePopEndTimes[0]);
+			continue;
+		}
+
+		INC_DWORD_STAT(STAT_LyraNumberPopsDisplayed);
+		DisplayNumberPop(Pending.Request);
+
+		Pending.bHasRequest = false;
+		Pending.ActivePopEndTimes.Add(CurrentTime + ConcurrentPopDuration);
+		NextFlushTime = FMath::Min(NextFlushTime, Pending.ActivePopEndTimes[0]);
+	}
+
+	if (PendingNumberPops.Num() > 0)
+	{
+		const float TimeUntilNextFlush = FMath::Max((float)(NextFlushTime - CurrentTime), UE_KINDA_SMALL_NUMBER);
+		World->GetTimerManager().SetTimer(FlushTimerHandle, this, &ThisClass::FlushPendingNumberPops, TimeUntilNextFlush);
+	}
+}
@@ -4,9 +4,11 @@
 
 #include "Components/ControllerComponent.h"
 #include "GameplayTagContainer.h"
+#include "UObject/ObjectKey.h"
 
 #include "LyraNumberPopComponent.generated.h"
 
+class AActor;
 class UObject;
 struct FFrame;
 
@@ -35,6 +37,11 @@ struct FLyraNumberPopRequest
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lyra|Number Pops")
 	bool bIsCriticalDamage = false;
 
+	// The actor the number is for, pops for the same target are merged together.
+	// The damage cue that builds the request has to set this (e.g., to the cue's target actor), otherwise pops are only merged by location when LocationMergeCellSize is set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lyra|Number Pops")
+	TObjectPtr<AActor> TargetActor = nullptr;
+
 	FLyraNumberPopRequest()
 		: WorldLocation(ForceInitToZero)
 	{
@@ -42,6 +49,20 @@ struct FLyraNumberPopRequest
 };
 
 
+/** Number pop requests for one target that are being merged before they are displayed */
+struct FLyraPendingNumberPop
+{
+	FLyraNumberPopRequest Request;
+
+	/** World time the merged pop will be displayed at */
+	double DisplayTime = 0.0;
+
+	/** World times the pops displayed recently for this target stop showing, for capping concurrent pops */
+	TArray<double, TInlineAllocator<4>> ActivePopEndTimes;
+
+	bool bHasRequest = false;
+};
+
 UCLASS(Abstract)
 class ULyraNumberPopComponent : public UControllerComponent
 {
@@ -51,7 +72,49 @@ public:
 
 	ULyraNumberPopComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
-	/** Adds a damage number to the damage number list for visualization */
+	/**
+	 * Adds a damage number to the damage number list for visualization.
+	 * Requests for the same target within AggregationWindow are merged into one pop (see DisplayNumberPop).
+	 */
 	UFUNCTION(BlueprintCallable, Category = Foo)
-	virtual void AddNumberPop(const FLyraNumberPopRequest& NewRequest) {}
+	void AddNumberPop(const FLyraNumberPopRequest& NewRequest);
+
+	//~UActorComponent interface
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	//~End of UActorComponent interface
+
+protected:
+	/** Actually displays a (possibly merged) number pop */
+	virtual void DisplayNumberPop(const FLyraNumberPopRequest& NewRequest) {}
+
+	/** Displays the pending pops that are due, and restarts the timer for the rest */
+	void FlushPendingNumberPops();
+
+	/** Pops for the same target within this many seconds are merged into one (summing the numbers), 0 merges them within a frame */
+	UPROPERTY(EditDefaultsOnly, Category = "Number Pop|Aggregation")
+	float AggregationWindow = 0.05f;
+
+	/** Maximum number of pops showing at once for a target, further requests keep adding to the next pop until one finishes (0 for no limit) */
+	UPROPERTY(EditDefaultsOnly, Category = "Number Pop|Aggregation")
+	int32 MaxConcurrentPopsPerTarget = 3;
+
+	/** How long a pop counts against MaxConcurrentPopsPerTarget after it is displayed */
+	UPROPERTY(EditDefaultsOnly, Category = "Number Pop|Aggregation")
+	float ConcurrentPopDuration = 1.0f;
+
+	/**
+	 * Pops for requests without a target actor are merged if they are within a cell of this size (0 displays them without merging).
+	 * Nearby targets can end up in the same cell and have their numbers summed, so prefer setting TargetActor on the request.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Number Pop|Aggregation")
+	float LocationMergeCellSize = 0.0f;
+
+private:
+	/** Either the target actor or the location cell of the request */
+	using FAggregationKey = TTuple<FObjectKey, FIntVector>;
+	FAggregationKey MakeAggregationKey(const FLyraNumberPopRequest& Request) const;
+
+	TMap<FAggregationKey, FLyraPendingNumberPop> PendingNumberPops;
+
+	FTimerHandle FlushTimerHandle;
 };
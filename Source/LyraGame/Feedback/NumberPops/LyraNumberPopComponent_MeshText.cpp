@@ -2,12 +2,16 @@
 
 #include "LyraNumberPopComponent_MeshText.h"
 
+#include "Components/InstancedStaticMeshComponent.h"
 #include "Components/StaticMeshComponent.h"
+#include "Containers/Ticker.h"
 #include "Engine/CollisionProfile.h"
 #include "Engine/Engine.h"
 #include "Engine/World.h"
 #include "Feedback/NumberPops/LyraNumberPopComponent.h"
+#include "GameFramework/Pawn.h"
 #include "LyraDamagePopStyle.h"
+#include "LyraLogChannels.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "TimerManager.h"
 #include "UObject/Package.h"
@@ -42,7 +46,7 @@ ULyraNumberPopComponent_MeshText::ULyraNumberPopComponent_MeshText(const FObject
 	NumberOfNumberRotations = 1.f;
 }
 
-void ULyraNumberPopComponent_MeshText::AddNumberPop(const FLyraNumberPopRequest& NewRequest)
+void ULyraNumberPopComponent_MeshText::DisplayNumberPop(const FLyraNumberPopRequest& NewRequest)
 {
 	// Drop requests for remote players on the floor
 	// (this prevents multiple pops from showing up for the host of a listen server)
@@ -54,6 +58,22 @@ void ULyraNumberPopComponent_MeshText::AddNumberPop(const FLyraNumberPopRequest&
 		}
 	}
 
+	if (bUseInstancedMeshes)
+	{
+		UStaticMesh* MeshToUse = DetermineStaticMesh(NewRequest);
+		if (MeshToUse == nullptr)
+		{
+			return;
+		}
+
+		FTransform CameraTransform;
+		FVector NumberLocation;
+		DetermineNumberLocation(NewRequest, /*out*/ CameraTransform, /*out*/ NumberLocation);
+
+		AddInstancedNumberPop(NewRequest, MeshToUse, CameraTransform, NumberLocation);
+		return;
+	}
+
 	FTempNumberPopInfo PreparedNumberInfo;
 
 	// Prepare the DamageNumberArray with the digits from the damage.
@@ -134,34 +154,147 @@ void ULyraNumberPopComponent_MeshText::AddNumberPop(const FLyraNumberPopRequest&
 			PreparedNumberInfo.MeshMIDs.Add(NewMID);
 		}
 
-		// Start the timer if it wasn't already running
-		if (!LocalWorld->GetTimerManager().IsTimerActive(ReleaseTimerHandle))
-		{
-			LocalWorld->GetTimerManager().SetTimer(ReleaseTimerHandle, this, &ThisClass::ReleaseNextComponents, ComponentLifespan);
-		}
+		StartReleaseTimer();
 	}
 
 	// Determine the position
 	FTransform CameraTransform;
-	FVector NumberLocation(NewRequest.WorldLocation);
+	FVector NumberLocation;
+	DetermineNumberLocation(NewRequest, /*out*/ CameraTransform, /*out*/ NumberLocation);
+	PreparedNumberInfo.StaticMeshComponent->SetWorldTransform(FTransform(CameraTransform.GetRotation(), NumberLocation));
+
+	// Now apply the material parameters to make the digits, etc...
+	SetMaterialParameters(NewRequest, PreparedNumberInfo, CameraTransform, NumberLocation);
+}
+
+void ULyraNumberPopComponent_MeshText::DetermineNumberLocation(const FLyraNumberPopRequest& Request, FTransform& OutCameraTransform, FVector& OutNumberLocation) const
+{
+	OutCameraTransform = FTransform::Identity;
+	OutNumberLocation = Request.WorldLocation;
 	if (APlayerController* PC = GetController<APlayerController>())
 	{
 		if (APlayerCameraManager* PlayerCameraManager = PC->PlayerCameraManager)
 		{
-			CameraTransform = FTransform(PlayerCameraManager->GetCameraRotation(), PlayerCameraManager->GetCameraLocation());
+			OutCameraTransform = FTransform(PlayerCameraManager->GetCameraRotation(), PlayerCameraManager->GetCameraLocation());
 
 			FVector LocationOffset(ForceInitToZero);
 
 			const float RandomMagnitude = 5.0f; //@TODO: Make this style driven
 			LocationOffset += FMath::RandPointInBox(FBox(FVector(-RandomMagnitude), FVector(RandomMagnitude)));
 
-			NumberLocation += LocationOffset;
+			OutNumberLocation += LocationOffset;
 		}
 	}
-	PreparedNumberInfo.StaticMeshComponent->SetWorldTransform(FTransform(CameraTransform.GetRotation(), NumberLocation));
+}
 
-	// Now apply the material parameters to make the digits, etc...
-	SetMaterialParameters(NewRequest, PreparedNumberInfo, CameraTransform, NumberLocation);
+void ULyraNumberPopComponent_MeshText::AddInstancedNumberPop(const FLyraNumberPopRequest& NewRequest, UStaticMesh* MeshToUse, const FTransform& CameraTransform, const FVector& NumberLocation)
+{
+	UWorld* LocalWorld = GetWorld();
+	check(LocalWorld);
+
+	FInstancedNumberPopMesh& InstancedMesh = InstancedMeshMap.FindOrAdd(MeshToUse);
+	if (InstancedMesh.Component == nullptr)
+	{
+		UInstancedStaticMeshComponent* NewComponent = NewObject<UInstancedStaticMeshComponent>(GetOwner());
+		NewComponent->SetupAttachment(nullptr);
+		NewComponent->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+		NewComponent->SetStaticMesh(MeshToUse);
+		NewComponent->SetNumCustomDataFloats(LyraNumberPopInstanceData::Count);
+		NewComponent->SetCastShadow(false);
+
+		// Used to allow post-processes to opt out of affecting the number pop digits
+		NewComponent->SetRenderCustomDepth(true);
+		NewComponent->SetCustomDepthStencilValue(123);
+
+		// The digits travel a great distance from their original bounds due to
+		// world position offset (WPO) animation in the material, so expand bounds
+		NewComponent->SetBoundsScale(2000.0f);
+
+		// These parameters are the same for every pop, the per-pop ones are in the custom data
+		for (int32 MatIdx = 0; MatIdx < NewComponent->GetNumMaterials(); ++MatIdx)
+		{
+			if (UMaterialInstanceDynamic* MeshMID = NewComponent->CreateDynamicMaterialInstance(MatIdx))
+			{
+				MeshMID->SetScalarParameterValue(AnimationLifespanParameterName, ComponentLifespan);
+
+				//@TODO: Determine whether or not we are spectating (see SetMaterialParameters)
+				MeshMID->SetScalarParameterValue(MoveToCameraParameterName, 1.0f);
+			}
+		}
+
+		NewComponent->RegisterComponent();
+		InstancedMesh.Component = NewComponent;
+	}
+
+	UInstancedStaticMeshComponent* Component = InstancedMesh.Component;
+	const FTransform InstanceTransform(CameraTransform.GetRotation(), NumberLocation);
+
+	int32 InstanceIndex = INDEX_NONE;
+	if (InstancedMesh.FreeInstances.Num() > 0)
+	{
+		InstanceIndex = InstancedMesh.FreeInstances.Pop(EAllowShrinking::No);
+		Component->UpdateInstanceTransform(InstanceIndex, InstanceTransform, /*bWorldSpace=*/ true, /*bMarkRenderStateDirty=*/ false, /*bTeleport=*/ true);
+	}
+	else
+	{
+		InstanceIndex = Component->AddInstance(InstanceTransform, /*bWorldSpace=*/ true);
+	}
+
+	// Fill out the digits, most significant first
+	float CustomData[LyraNumberPopInstanceData::Count] = {};
+	{
+		int32 Digits[LyraNumberPopInstanceData::MaxDigits];
+		int32 NumDigits = 0;
+
+		// IF the number has more digits than we support
+		// THEN show the highest number we can support
+		int32 LocalNumber = FMath::Max(NewRequest.NumberToDisplay, 0);
+		const int32 MaxSupportedNumber = 99999999;
+		LocalNumber = FMath::Min(LocalNumber, MaxSupportedNumber);
+		do
+		{
+			Digits[NumDigits++] = LocalNumber % 10;
+			LocalNumber /= 10;
+		}
+		while (LocalNumber > 0);
+
+		CustomData[LyraNumberPopInstanceData::NumDigits] = NumDigits;
+		for (int32 DigitIndex = 0; DigitIndex < NumDigits; ++DigitIndex)
+		{
+			CustomData[LyraNumberPopInstanceData::FirstDigit + DigitIndex] = Digits[NumDigits - 1 - DigitIndex];
+		}
+	}
+
+	const FLinearColor Color = DetermineColor(NewRequest);
+	CustomData[LyraNumberPopInstanceData::ColorR] = Color.R;
+	CustomData[LyraNumberPopInstanceData::ColorG] = Color.G;
+	CustomData[LyraNumberPopInstanceData::ColorB] = Color.B;
+	CustomData[LyraNumberPopInstanceData::SpawnTime] = LocalWorld->GetRealTimeSeconds();
+
+	const float DistanceFromCameraToNumber = (CameraTransform.GetLocation() - NumberLocation).Size();
+	const float DistanceSpriteScale = DistanceFromCameraBeforeDoublingSize == 0.f ? 1.f : FMath::Clamp(DistanceFromCameraToNumber / DistanceFromCameraBeforeDoublingSize, 1.f, 1000000000.f);
+	const float HitSizeMultiplier = NewRequest.bIsCriticalDamage ? CriticalHitSizeMultiplier : 1.f;
+	CustomData[LyraNumberPopInstanceData::SizeMultiplier] = HitSizeMultiplier * DistanceSpriteScale;
+	CustomData[LyraNumberPopInstanceData::IsCriticalHit] = NewRequest.bIsCriticalDamage ? 1.f : 0.f;
+	CustomData[LyraNumberPopInstanceData::RandomSeed] = FMath::FRand();
+
+	// Render state is only sent once at the end of the frame, no matter how many pops were added
+	Component->SetCustomData(InstanceIndex, MakeArrayView(CustomData), /*bMarkRenderStateDirty=*/ true);
+
+	LiveInstances.Emplace(MeshToUse, InstanceIndex, LocalWorld->GetTimeSeconds() + ComponentLifespan);
+	StartReleaseTimer();
+}
+
+void ULyraNumberPopComponent_MeshText::StartReleaseTimer()
+{
+	UWorld* LocalWorld = GetWorld();
+	check(LocalWorld);
+
+	// Start the timer if it wasn't already running
+	if (!LocalWorld->GetTimerManager().IsTimerActive(ReleaseTimerHandle))
+	{
+		LocalWorld->GetTimerManager().SetTimer(ReleaseTimerHandle, this, &ThisClass::ReleaseNextComponents, ComponentLifespan);
+	}
 }
 
 void ULyraNumberPopComponent_MeshText::ReleaseNextComponents()
@@ -204,10 +337,37 @@ void ULyraNumberPopComponent_MeshText::ReleaseNextComponents()
 	// Actually remove it from the live components array
 	LiveComponents.RemoveAt(0, NumReleased);
 
+	// Hide the instances that finished animating and free them up for the next pops
+	int32 NumInstancesReleased = 0;
+	for (const FLiveNumberPopInstance& LiveInstance : LiveInstances)
+	{
+		if (CurrentTime < LiveInstance.ReleaseTime)
+		{
+			break;
+		}
+
+		NumInstancesReleased++;
+		if (FInstancedNumberPopMesh* InstancedMesh = InstancedMeshMap.Find(LiveInstance.Mesh))
+		{
+			if (InstancedMesh->Component != nullptr)
+			{
+				InstancedMesh->Component->UpdateInstanceTransform(LiveInstance.InstanceIndex, FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), /*bWorldSpace=*/ true, /*bMarkRenderStateDirty=*/ true, /*bTeleport=*/ true);
+				InstancedMesh->FreeInstances.Push(LiveInstance.InstanceIndex);
+			}
+		}
+	}
+	LiveInstances.RemoveAt(0, NumInstancesReleased);
+
 	// If we still have live components animating, set the timer to remove the next one
-	if (LiveComponents.Num() > 0)
+	if ((LiveComponents.Num() > 0) || (LiveInstances.Num() > 0))
 	{
-		const float TimeUntilNextRelease = LiveComponents[0].ReleaseTime - CurrentTime;
+		float NextReleaseTime = (LiveComponents.Num() > 0) ? LiveComponents[0].ReleaseTime : LiveInstances[0].ReleaseTime;
+		if (LiveInstances.Num() > 0)
+		{
+			NextReleaseTime = FMath::Min(NextReleaseTime, LiveInstances[0].ReleaseTime);
+		}
+
+		const float TimeUntilNextRelease = FMath::Max(NextReleaseTime - CurrentTime, UE_KINDA_SMALL_NUMBER);
 		LocalWorld->GetTimerManager().SetTimer(ReleaseTimerHandle, this, &ThisClass::ReleaseNextComponents, TimeUntilNextRelease);
 	}
 }
@@ -334,3 +494,91 @@ void ULyraNumberPopComponent_MeshText::SetMaterialParameters(const FLyraNumberPo
 	}
 }
 
+
+//////////////////////////////////////////////////////////////////////
+
+#if !UE_BUILD_SHIPPING
+void ULyraNumberPopComponent_MeshText::StressTest(UWorld* World, int32 PopsPerSecond, float DurationSeconds, FOutputDevice& Ar)
+{
+	APlayerController* PC = (World != nullptr) ? World->GetFirstPlayerController() : nullptr;
+	ULyraNumberPopComponent_MeshText* NumberPopComponent = (PC != nullptr) ? PC->FindComponentByClass<ULyraNumberPopComponent_MeshText>() : nullptr;
+	if ((NumberPopComponent == nullptr) || (PC->GetPawn() == nullptr))
+	{
+		Ar.Logf(TEXT("No local player with a pawn and a mesh text number pop component"));
+		return;
+	}
+
+	struct FStressTestState
+	{
+		double ElapsedTime = 0.0;
+		double PopsOwed = 0.0;
+		int32 NumSpawned = 0;
+		int32 NumFrames = 0;
+		int32 PeakLivePops = 0;
+		double MaxFrameTime = 0.0;
+	};
+	TSharedRef<FStressTestState> State = MakeShared<FStressTestState>();
+
+	Ar.Logf(TEXT("Spawning %d number pops per second for %.1f seconds (%s)"), PopsPerSecond, DurationSeconds, NumberPopComponent->bUseInstancedMeshes ? TEXT("instanced") : TEXT("component per pop"));
+
+	TWeakObjectPtr<ULyraNumberPopComponent_MeshText> WeakComponent(NumberPopComponent);
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakComponent, State, PopsPerSecond, DurationSeconds](float DeltaTime)
+	{
+		ULyraNumberPopComponent_MeshText* Component = WeakComponent.Get();
+		APlayerController* OwningPC = (Component != nullptr) ? Component->GetController<APlayerController>() : nullptr;
+		APawn* Pawn = (OwningPC != nullptr) ? OwningPC->GetPawn() : nullptr;
+		if (Pawn == nullptr)
+		{
+			return false;
+		}
+
+		State->ElapsedTime += DeltaTime;
+		State->NumFrames++;
+		State->MaxFrameTime = FMath::Max(State->MaxFrameTime, (double)DeltaTime);
+
+		// Spread the pops over a ring in front of the pawn, like a big fight would
+		State->PopsOwed += PopsPerSecond * DeltaTime;
+		const FVector Origin = Pawn->GetActorLocation() + Pawn->GetActorForwardVector() * 1000.0f;
+		while (State->PopsOwed >= 1.0)
+		{
+			State->PopsOwed -= 1.0;
+
+			FLyraNumberPopRequest Request;
+			Request.WorldLocation = Origin + FMath::VRand() * FMath::FRandRange(0.0f, 800.0f);
+			Request.NumberToDisplay = FMath::RandRange(1, 250);
+			Request.bIsCriticalDamage = FMath::FRand() < 0.1f;
+			Component->AddNumberPop(Request);
+			State->NumSpawned++;
+		}
+
+		const int32 NumLivePops = Component->LiveComponents.Num() + Component->LiveInstances.Num();
+		State->PeakLivePops = FMath::Max(State->PeakLivePops, NumLivePops);
+
+		if (State->ElapsedTime < DurationSeconds)
+		{
+			return true;
+		}
+
+		int32 NumComponents = Component->InstancedMeshMap.Num() + Component->LiveComponents.Num();
+		for (const TPair<TObjectPtr<UStaticMesh>, FPooledNumberPopComponentList>& Pair : Component->PooledComponentMap)
+		{
+			NumComponents += Pair.Value.Components.Num();
+		}
+
+		UE_LOG(LogLyra, Display, TEXT("Number pop stress test: %d pops in %.2f s, %d peak live, %d mesh components, %.2f ms average frame, %.2f ms worst frame"),
+			State->NumSpawned, State->ElapsedTime, State->PeakLivePops, NumComponents,
+			1000.0 * State->ElapsedTime / FMath::Max(State->NumFrames, 1), 1000.0 * State->MaxFrameTime);
+		return false;
+	}));
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice NumberPopStressTestCommand(
+	TEXT("Lyra.NumberPops.StressTest"),
+	TEXT("Spawns number pops around the local player to measure their cost. Usage: Lyra.NumberPops.StressTest [PopsPerSecond=1000] [Seconds=10]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		const int32 PopsPerSecond = (Args.Num() > 0) ? FCString::Atoi(*Args[0]) : 1000;
+		const float DurationSeconds = (Args.Num() > 1) ? FCString::Atof(*Args[1]) : 10.0f;
+		ULyraNumberPopComponent_MeshText::StressTest(World, FMath::Max(PopsPerSecond, 1), FMath::Max(DurationSeconds, 0.1f), Ar);
+	}));
+#endif
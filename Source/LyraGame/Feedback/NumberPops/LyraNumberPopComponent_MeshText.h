@@ -8,6 +8,7 @@
 
 class ULyraDamagePopStyle;
 class UMaterialInstanceDynamic;
+class UInstancedStaticMeshComponent;
 class UObject;
 class UStaticMesh;
 class UStaticMeshComponent;
@@ -44,6 +45,67 @@ struct FLiveNumberPopEntry
 	{}
 };
 
+/** One instanced mesh component that draws every number pop using a mesh, with the instances free for reuse */
+USTRUCT()
+struct FInstancedNumberPopMesh
+{
+	GENERATED_BODY()
+
+	UPROPERTY(transient)
+	TObjectPtr<UInstancedStaticMeshComponent> Component = nullptr;
+
+	/** Instances that have finished animating and can be reused by the next pop */
+	TArray<int32> FreeInstances;
+};
+
+USTRUCT()
+struct FLiveNumberPopInstance
+{
+	GENERATED_BODY()
+
+	/** The mesh (key into InstancedMeshMap) the instance belongs to */
+	UPROPERTY(transient)
+	TObjectPtr<UStaticMesh> Mesh = nullptr;
+
+	int32 InstanceIndex = INDEX_NONE;
+
+	/** The world time that this instance will be hidden and freed for reuse */
+	float ReleaseTime = 0.0f;
+
+	FLiveNumberPopInstance()
+	{}
+
+	FLiveNumberPopInstance(UStaticMesh* InMesh, int32 InInstanceIndex, float InReleaseTime)
+		: Mesh(InMesh), InstanceIndex(InInstanceIndex), ReleaseTime(InReleaseTime)
+	{}
+};
+
+/**
+ * Layout of the per-instance custom data when drawing number pops with instanced meshes,
+ * the mesh's material needs to read these with PerInstanceCustomData
+ */
+namespace LyraNumberPopInstanceData
+{
+	// The number of digits (not counting the sign)
+	constexpr int32 NumDigits = 0;
+	// The digits, most significant first
+	constexpr int32 FirstDigit = 1;
+	constexpr int32 MaxDigits = 8;
+	// Linear color RGB
+	constexpr int32 ColorR = FirstDigit + MaxDigits;
+	constexpr int32 ColorG = ColorR + 1;
+	constexpr int32 ColorB = ColorR + 2;
+	// Real time in seconds when the pop was spawned (its lifespan is AnimationLifespanParameterName on the material)
+	constexpr int32 SpawnTime = ColorB + 1;
+	// Size multiplier from distance to the camera and critical hits
+	constexpr int32 SizeMultiplier = SpawnTime + 1;
+	// 1 for critical hits, 0 otherwise
+	constexpr int32 IsCriticalHit = SizeMultiplier + 1;
+	// Random 0..1 value for variation in the animation
+	constexpr int32 RandomSeed = IsCriticalHit + 1;
+	constexpr int32 Count = RandomSeed + 1;
+}
+
 /** Struct that holds the info for a new damage number */
 struct FTempNumberPopInfo
 {
@@ -66,13 +128,24 @@ public:
 
 	ULyraNumberPopComponent_MeshText(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
+#if !UE_BUILD_SHIPPING
+	/** Spawns PopsPerSecond number pops around the local player's pawn for DurationSeconds and reports the frame time and live pop counts */
+	static void StressTest(UWorld* World, int32 PopsPerSecond, float DurationSeconds, FOutputDevice& Ar);
+#endif
+
+protected:
 	//~ULyraNumberPopComponent interface
-	virtual void AddNumberPop(const FLyraNumberPopRequest& NewRequest) override;
+	virtual void DisplayNumberPop(const FLyraNumberPopRequest& NewRequest) override;
 	//~End of ULyraNumberPopComponent interface
 
-protected:
 	void SetMaterialParameters(const FLyraNumberPopRequest& Request, FTempNumberPopInfo& NewDamageNumberInfo, const FTransform& CameraTransform, const FVector& NumberLocation);
 
+	/** Draws the number pop as an instance of a shared instanced mesh component (see bUseInstancedMeshes) */
+	void AddInstancedNumberPop(const FLyraNumberPopRequest& NewRequest, UStaticMesh* MeshToUse, const FTransform& CameraTransform, const FVector& NumberLocation);
+
+	/** Returns the transform and location to spawn the number pop at, facing the camera with a bit of random offset */
+	void DetermineNumberLocation(const FLyraNumberPopRequest& Request, FTransform& OutCameraTransform, FVector& OutNumberLocation) const;
+
 	FLinearColor DetermineColor(const FLyraNumberPopRequest& Request) const;
 	UStaticMesh* DetermineStaticMesh(const FLyraNumberPopRequest& Request) const;
 
@@ -80,6 +153,17 @@ protected:
 	/** Releases components back to the pool that have exceeded their lifespan */
 	void ReleaseNextComponents();
 
+	/** Starts the release timer if it isn't running already */
+	void StartReleaseTimer();
+
+	/**
+	 * Draws every pop for a mesh as an instance of one instanced static mesh component (with the digits, color and
+	 * spawn time in per-instance custom data, see LyraNumberPopInstanceData) instead of one component per pop.
+	 * The style meshes need a material that reads per-instance custom data to use this.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Number Pop|Style")
+	bool bUseInstancedMeshes = false;
+
 	/** Style patterns to attempt to apply to the incoming number pops */
 	UPROPERTY(EditDefaultsOnly, Category="Number Pop|Style")
 	TArray<TObjectPtr<ULyraDamagePopStyle>> Styles;
@@ -136,5 +220,12 @@ protected:
 	UPROPERTY(transient)
 	TArray<FLiveNumberPopEntry> LiveComponents;
 
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UStaticMesh>, FInstancedNumberPopMesh> InstancedMeshMap;
+
+	/** Live instances, in the order they will be released */
+	UPROPERTY(transient)
+	TArray<FLiveNumberPopInstance> LiveInstances;
+
 	FTimerHandle ReleaseTimerHandle;
 };
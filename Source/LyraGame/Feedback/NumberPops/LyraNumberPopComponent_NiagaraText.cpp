@@ -17,7 +17,7 @@ ULyraNumberPopComponent_NiagaraText::ULyraNumberPopComponent_NiagaraText(const F
 
 }
 
-void ULyraNumberPopComponent_NiagaraText::AddNumberPop(const FLyraNumberPopRequest& NewRequest)
+void ULyraNumberPopComponent_NiagaraText::DisplayNumberPop(const FLyraNumberPopRequest& NewRequest)
 {
 	int32 LocalDamage = NewRequest.NumberToDisplay;
 
@@ -19,12 +19,11 @@ public:
 
 	ULyraNumberPopComponent_NiagaraText(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
+protected:
 	//~ULyraNumberPopComponent interface
-	virtual void AddNumberPop(const FLyraNumberPopRequest& NewRequest) override;
+	virtual void DisplayNumberPop(const FLyraNumberPopRequest& NewRequest) override;
 	//~End of ULyraNumberPopComponent interface
 
-protected:
-	
 	TArray<int32> DamageNumberArray;
 
 	/** Style patterns to attempt to apply to the incoming number pops */
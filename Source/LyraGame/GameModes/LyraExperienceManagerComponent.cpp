@@ -13,6 +13,7 @@
 #include "TimerManager.h"
 #include "Settings/LyraSettingsLocal.h"
 #include "LyraLogChannels.h"
+#include "AbilitySystem/LyraGameplayCueManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraExperienceManagerComponent)
 
@@ -342,6 +343,12 @@ void ULyraExperienceManagerComponent::OnExperienceFullLoadCompleted()
 		}
 	}
 
+	// Now that everything the experience grants is loaded, start loading the gameplay cues it can trigger
+	if (ULyraGameplayCueManager* GCM = ULyraGameplayCueManager::Get())
+	{
+		GameplayCuePreloadHandle = GCM->PreloadCuesForExperience(CurrentExperience);
+	}
+
 	LoadState = ELyraExperienceLoadState::Loaded;
 
 	OnExperienceLoaded_HighPriority.Broadcast(CurrentExperience);
@@ -451,6 +458,11 @@ bool ULyraExperienceManagerComponent::ShouldShowLoadingScreen(FString& OutReason
 		OutReason = TEXT("Experience still loading");
 		return true;
 	}
+	else if (GameplayCuePreloadHandle.IsValid() && GameplayCuePreloadHandle->IsLoadingInProgress())
+	{
+		OutReason = TEXT("Preloading gameplay cues");
+		return true;
+	}
 	else
 	{
 		return false;
@@ -12,6 +12,7 @@
 namespace UE::GameFeatures { struct FResult; }
 
 class ULyraExperienceDefinition;
+struct FStreamableHandle;
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnLyraExperienceLoaded, const ULyraExperienceDefinition* /*Experience*/);
 
@@ -90,6 +91,9 @@ private:
 	int32 NumObservedPausers = 0;
 	int32 NumExpectedPausers = 0;
 
+	// Gameplay cues the experience can trigger, preloaded while the loading screen is still up
+	TSharedPtr<FStreamableHandle> GameplayCuePreloadHandle;
+
 	/**
 	 * Delegate called when the experience has finished loading just before others
 	 * (e.g., subsystems that set up for regular gameplay)
@@ -1,11 +1,58 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "PhysicalMaterialWithTags.h"
+#include "NativeGameplayTags.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(PhysicalMaterialWithTags)
 
+UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Gameplay_Zone, "Gameplay.Zone");
+
+std::atomic<uint32> UPhysicalMaterialWithTags::TagsGeneration{1};
+
 UPhysicalMaterialWithTags::UPhysicalMaterialWithTags(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 }
 
+void UPhysicalMaterialWithTags::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Covers materials that are never loaded from disk (created at runtime or duplicated), loaded ones are handled in PostLoad
+	// and the CDO is never hit, so neither needs to flush the caches keyed on the tags generation
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_NeedLoad))
+	{
+		UpdateCachedTags();
+	}
+}
+
+void UPhysicalMaterialWithTags::PostLoad()
+{
+	Super::PostLoad();
+
+	UpdateCachedTags();
+}
+
+#if WITH_EDITOR
+void UPhysicalMaterialWithTags::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	UpdateCachedTags();
+}
+#endif
+
+void UPhysicalMaterialWithTags::UpdateCachedTags()
+{
+	HitZone = FGameplayTag();
+	for (const FGameplayTag MaterialTag : Tags)
+	{
+		if (MaterialTag.MatchesTag(TAG_Gameplay_Zone))
+		{
+			HitZone = MaterialTag;
+			break;
+		}
+	}
+
+	TagsGeneration.fetch_add(1, std::memory_order_relaxed);
+}
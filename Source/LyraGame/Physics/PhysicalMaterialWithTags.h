@@ -5,6 +5,8 @@
 #include "GameplayTagContainer.h"
 #include "PhysicalMaterials/PhysicalMaterial.h"
 
+#include <atomic>
+
 #include "PhysicalMaterialWithTags.generated.h"
 
 class UObject;
@@ -22,7 +24,37 @@ class UPhysicalMaterialWithTags : public UPhysicalMaterial
 public:
 	UPhysicalMaterialWithTags(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
+	//~UObject interface
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~End of UObject interface
+
+	// Returns the first tag in Tags that is a Gameplay.Zone tag (or an empty tag if there isn't one)
+	FGameplayTag GetHitZone() const
+	{
+		return HitZone;
+	}
+
+	// Returns a counter that changes whenever any physical material's tags are (re)loaded or edited,
+	// so caches derived from the tags know to rebuild
+	static uint32 GetTagsGeneration()
+	{
+		return TagsGeneration.load(std::memory_order_relaxed);
+	}
+
 	// A container of gameplay tags that game code can use to reason about this physical material
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=PhysicalProperties)
 	FGameplayTagContainer Tags;
+
+private:
+	void UpdateCachedTags();
+
+private:
+	FGameplayTag HitZone;
+
+	// Bumped from PostInitProperties / PostLoad, which can run on the async loading thread
+	static std::atomic<uint32> TagsGeneration;
 };
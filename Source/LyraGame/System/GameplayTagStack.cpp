@@ -4,6 +4,12 @@
 
 #include "UObject/Stack.h"
 
+#if !UE_BUILD_SHIPPING
+#include "GameplayTagsManager.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/CoreNet.h"
+#endif
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GameplayTagStack)
 
 //////////////////////////////////////////////////////////////////////
@@ -17,6 +23,34 @@ FString FGameplayTagStack::GetDebugString() const
 //////////////////////////////////////////////////////////////////////
 // FGameplayTagStackContainer
 
+int32 FGameplayTagStackContainer::FindStackIndex(FGameplayTag Tag)
+{
+	if (const int32* StackIndex = TagToIndexMap.Find(Tag))
+	{
+		if (Stacks.IsValidIndex(*StackIndex) && (Stacks[*StackIndex].Tag == Tag))
+		{
+			return *StackIndex;
+		}
+	}
+	else if (TagToIndexMap.Num() == Stacks.Num())
+	{
+		// Every stack is accounted for, so there isn't one for this tag
+		return INDEX_NONE;
+	}
+
+	TagToIndexMap.Reset();
+	int32 FoundIndex = INDEX_NONE;
+	for (int32 StackIndex = 0; StackIndex < Stacks.Num(); ++StackIndex)
+	{
+		TagToIndexMap.Add(Stacks[StackIndex].Tag, StackIndex);
+		if (Stacks[StackIndex].Tag == Tag)
+		{
+			FoundIndex = StackIndex;
+		}
+	}
+	return FoundIndex;
+}
+
 void FGameplayTagStackContainer::AddStack(FGameplayTag Tag, int32 StackCount)
 {
 	if (!Tag.IsValid())
@@ -27,18 +61,18 @@ void FGameplayTagStackContainer::AddStack(FGameplayTag Tag, int32 StackCount)
 
 	if (StackCount > 0)
 	{
-		for (FGameplayTagStack& Stack : Stacks)
+		const int32 StackIndex = FindStackIndex(Tag);
+		if (StackIndex != INDEX_NONE)
 		{
-			if (Stack.Tag == Tag)
-			{
-				const int32 NewCount = Stack.StackCount + StackCount;
-				Stack.StackCount = NewCount;
-				TagToCountMap[Tag] = NewCount;
-				MarkItemDirty(Stack);
-				return;
-			}
+			FGameplayTagStack& Stack = Stacks[StackIndex];
+			const int32 NewCount = Stack.StackCount + StackCount;
+			Stack.StackCount = NewCount;
+			TagToCountMap[Tag] = NewCount;
+			MarkItemDirty(Stack);
+			return;
 		}
 
+		TagToIndexMap.Add(Tag, Stacks.Num());
 		FGameplayTagStack& NewStack = Stacks.Emplace_GetRef(Tag, StackCount);
 		MarkItemDirty(NewStack);
 		TagToCountMap.Add(Tag, StackCount);
@@ -56,26 +90,32 @@ void FGameplayTagStackContainer::RemoveStack(FGameplayTag Tag, int32 StackCount)
 	//@TODO: Should we error if you try to remove a stack that doesn't exist or has a smaller count?
 	if (StackCount > 0)
 	{
-		for (auto It = Stacks.CreateIterator(); It; ++It)
+		const int32 StackIndex = FindStackIndex(Tag);
+		if (StackIndex == INDEX_NONE)
+		{
+			return;
+		}
+
+		FGameplayTagStack& Stack = Stacks[StackIndex];
+		if (Stack.StackCount <= StackCount)
 		{
-			FGameplayTagStack& Stack = *It;
-			if (Stack.Tag == Tag)
+			TagToCountMap.Remove(Tag);
+			TagToIndexMap.Remove(Tag);
+
+			// Items are replicated by ReplicationID rather than by index, so the stack moved into the freed slot doesn't need to be sent again
+			Stacks.RemoveAtSwap(StackIndex, EAllowShrinking::No);
+			if (Stacks.IsValidIndex(StackIndex))
 			{
-				if (Stack.StackCount <= StackCount)
-				{
-					It.RemoveCurrent();
-					TagToCountMap.Remove(Tag);
-					MarkArrayDirty();
-				}
-				else
-				{
-					const int32 NewCount = Stack.StackCount - StackCount;
-					Stack.StackCount = NewCount;
-					TagToCountMap[Tag] = NewCount;
-					MarkItemDirty(Stack);
-				}
-				return;
+				TagToIndexMap.Add(Stacks[StackIndex].Tag, StackIndex);
 			}
+			MarkArrayDirty();
+		}
+		else
+		{
+			const int32 NewCount = Stack.StackCount - StackCount;
+			Stack.StackCount = NewCount;
+			TagToCountMap[Tag] = NewCount;
+			MarkItemDirty(Stack);
 		}
 	}
 }
@@ -87,6 +127,9 @@ void FGameplayTagStackContainer::PreReplicatedRemove(const TArrayView<int32> Rem
 		const FGameplayTag Tag = Stacks[Index].Tag;
 		TagToCountMap.Remove(Tag);
 	}
+
+	// The stacks are about to be moved around
+	TagToIndexMap.Reset();
 }
 
 void FGameplayTagStackContainer::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
@@ -95,6 +138,7 @@ void FGameplayTagStackContainer::PostReplicatedAdd(const TArrayView<int32> Added
 	{
 		const FGameplayTagStack& Stack = Stacks[Index];
 		TagToCountMap.Add(Stack.Tag, Stack.StackCount);
+		TagToIndexMap.Add(Stack.Tag, Index);
 	}
 }
 
@@ -107,3 +151,143 @@ void FGameplayTagStackContainer::PostReplicatedChange(const TArrayView<int32> Ch
 	}
 }
 
+
+#if !UE_BUILD_SHIPPING
+namespace GameplayTagStackReplication
+{
+	// Counts the bits the fast array would write for the items added, changed or removed since the last call (the delta header is the same either way and is left out)
+	struct FDeltaCounter
+	{
+		TMap<int32, int32> LastKeyById;
+		int64 NumBits = 0;
+		int32 NumChangedItems = 0;
+		int32 NumDeletedItems = 0;
+
+		void Accumulate(const TArray<FGameplayTagStack>& Stacks, TFunctionRef<void(const FGameplayTagStack&, FArchive&)> SerializeItem)
+		{
+			TMap<int32, int32> KeyById;
+			for (const FGameplayTagStack& Stack : Stacks)
+			{
+				KeyById.Add(Stack.ReplicationID, Stack.ReplicationKey);
+
+				const int32* LastKey = LastKeyById.Find(Stack.ReplicationID);
+				if ((LastKey == nullptr) || (*LastKey != Stack.ReplicationKey))
+				{
+					FNetBitWriter Writer(nullptr, 256);
+					uint32 ReplicationID = (uint32)Stack.ReplicationID;
+					Writer.SerializeIntPacked(ReplicationID);
+					SerializeItem(Stack, Writer);
+					NumBits += Writer.GetNumBits();
+					++NumChangedItems;
+				}
+			}
+
+			for (const TPair<int32, int32>& LastKey : LastKeyById)
+			{
+				if (!KeyById.Contains(LastKey.Key))
+				{
+					FNetBitWriter Writer(nullptr, 64);
+					uint32 ReplicationID = (uint32)LastKey.Key;
+					Writer.SerializeIntPacked(ReplicationID);
+					NumBits += Writer.GetNumBits();
+					++NumDeletedItems;
+				}
+			}
+
+			LastKeyById = MoveTemp(KeyById);
+		}
+	};
+}
+
+void FGameplayTagStackContainer::ReportReplicationBytes(int32 NumStacks, int32 CountPerStack, FOutputDevice& Ar)
+{
+	FGameplayTagContainer AllTags;
+	UGameplayTagsManager::Get().RequestAllGameplayTags(/*out*/ AllTags, /*OnlyIncludeDictionaryTags=*/ true);
+
+	TArray<FGameplayTag> Tags;
+	AllTags.GetGameplayTagArray(/*out*/ Tags);
+	Tags.SetNum(FMath::Min(Tags.Num(), NumStacks));
+	if (Tags.Num() == 0)
+	{
+		Ar.Logf(TEXT("No gameplay tags to build stacks from"));
+		return;
+	}
+
+	auto SerializeItem = [](const FGameplayTagStack& Stack, FArchive& Writer)
+	{
+		bool bSuccess = true;
+		FGameplayTag Tag = Stack.Tag;
+		Tag.NetSerialize(Writer, nullptr, bSuccess);
+		int32 StackCount = Stack.StackCount;
+		Writer << StackCount;
+	};
+
+	// Deplete every stack from the front of the array, like ammo being spent
+	auto RunScenario = [&](bool bOrderedRemoval, int32& OutNumMovedStacks)
+	{
+		FGameplayTagStackContainer Container;
+		GameplayTagStackReplication::FDeltaCounter Counter;
+		OutNumMovedStacks = 0;
+
+		for (const FGameplayTag& Tag : Tags)
+		{
+			Container.AddStack(Tag, CountPerStack);
+		}
+		Counter.Accumulate(Container.Stacks, SerializeItem);
+
+		// Only count what depleting the stacks sends
+		Counter.NumBits = 0;
+		Counter.NumChangedItems = 0;
+		Counter.NumDeletedItems = 0;
+
+		for (const FGameplayTag& Tag : Tags)
+		{
+			for (int32 Count = 0; Count < CountPerStack; ++Count)
+			{
+				const int32 StackIndex = Container.FindStackIndex(Tag);
+				if (bOrderedRemoval && (StackIndex != INDEX_NONE) && (Container.Stacks[StackIndex].StackCount <= 1))
+				{
+					// The removal RemoveStack did before it swap-removed
+					OutNumMovedStacks += Container.Stacks.Num() - StackIndex - 1;
+					Container.Stacks.RemoveAt(StackIndex);
+					Container.TagToCountMap.Remove(Tag);
+					Container.TagToIndexMap.Reset();
+					Container.MarkArrayDirty();
+				}
+				else
+				{
+					if (!bOrderedRemoval && (StackIndex != INDEX_NONE) && (Container.Stacks[StackIndex].StackCount <= 1))
+					{
+						OutNumMovedStacks += (StackIndex < Container.Stacks.Num() - 1) ? 1 : 0;
+					}
+					Container.RemoveStack(Tag, 1);
+				}
+
+				// One replication update per shot
+				Counter.Accumulate(Container.Stacks, SerializeItem);
+			}
+		}
+
+		return Counter;
+	};
+
+	int32 NumOrderedMoves = 0;
+	int32 NumSwapMoves = 0;
+	const GameplayTagStackReplication::FDeltaCounter Ordered = RunScenario(/*bOrderedRemoval=*/ true, /*out*/ NumOrderedMoves);
+	const GameplayTagStackReplication::FDeltaCounter Swapped = RunScenario(/*bOrderedRemoval=*/ false, /*out*/ NumSwapMoves);
+
+	Ar.Logf(TEXT("Depleting %d stacks of %d (one update per count removed), item payloads only:"), Tags.Num(), CountPerStack);
+	Ar.Logf(TEXT("  Ordered removal: %lld bytes, %d items sent, %d deletes, %d stacks shifted"), (Ordered.NumBits + 7) / 8, Ordered.NumChangedItems, Ordered.NumDeletedItems, NumOrderedMoves);
+	Ar.Logf(TEXT("  Swap removal:    %lld bytes, %d items sent, %d deletes, %d stacks moved"), (Swapped.NumBits + 7) / 8, Swapped.NumChangedItems, Swapped.NumDeletedItems, NumSwapMoves);
+}
+
+static FAutoConsoleCommandWithArgsAndOutputDevice GameplayTagStackReplicationReportCommand(
+	TEXT("Lyra.GameplayTagStack.ReplicationReport"),
+	TEXT("Compares the replicated item bytes of ordered and swap removal of gameplay tag stacks. Usage: Lyra.GameplayTagStack.ReplicationReport [NumStacks=8] [CountPerStack=30]"),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		const int32 NumStacks = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 8;
+		const int32 CountPerStack = (Args.Num() > 1) ? FMath::Max(1, FCString::Atoi(*Args[1])) : 30;
+		FGameplayTagStackContainer::ReportReplicationBytes(NumStacks, CountPerStack, Ar);
+	}));
+#endif // !UE_BUILD_SHIPPING
@@ -7,6 +7,7 @@
 
 #include "GameplayTagStack.generated.h"
 
+class FOutputDevice;
 struct FGameplayTagStackContainer;
 struct FNetDeltaSerializeInfo;
 
@@ -80,13 +81,24 @@ public:
 		return FFastArraySerializer::FastArrayDeltaSerialize<FGameplayTagStack, FGameplayTagStackContainer>(Stacks, DeltaParms, *this);
 	}
 
+#if !UE_BUILD_SHIPPING
+	// Depletes stacks one count at a time with swap removal and with the previous ordered removal, and reports the bits each sends (Lyra.GameplayTagStack.ReplicationReport)
+	static void ReportReplicationBytes(int32 NumStacks, int32 CountPerStack, FOutputDevice& Ar);
+#endif
+
 private:
+	// Returns the index of the stack for the tag in Stacks (or INDEX_NONE), rebuilding TagToIndexMap if it is out of date
+	int32 FindStackIndex(FGameplayTag Tag);
+
 	// Replicated list of gameplay tag stacks
 	UPROPERTY()
 	TArray<FGameplayTagStack> Stacks;
 	
 	// Accelerated list of tag stacks for queries
 	TMap<FGameplayTag, int32> TagToCountMap;
+
+	// Index of each tag's stack in Stacks, validated on use since replication can reorder the stacks on clients
+	TMap<FGameplayTag, int32> TagToIndexMap;
 };
 
 template<>
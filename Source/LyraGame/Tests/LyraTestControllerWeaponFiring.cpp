@@ -0,0 +1,399 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Tests/LyraTestControllerWeaponFiring.h"
+
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Equipment/LyraEquipmentManagerComponent.h"
+#include "Equipment/LyraQuickBarComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameModes/LyraBotCreationComponent.h"
+#include "GameModes/LyraExperienceManagerComponent.h"
+#include "HAL/FileManager.h"
+#include "Inventory/LyraInventoryItemDefinition.h"
+#include "Inventory/LyraInventoryManagerComponent.h"
+#include "LyraLogChannels.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Teams/LyraTeamSubsystem.h"
+#include "Weapons/LyraGameplayAbility_RangedWeapon.h"
+#include "Weapons/LyraRangedWeaponInstance.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(LyraTestControllerWeaponFiring)
+
+namespace LyraWeaponFiringTest
+{
+	// The weapons tested when -WeaponFiringItems isn't specified
+	static const TCHAR* DefaultWeaponItems[] =
+	{
+		TEXT("/ShooterCore/Weapons/Rifle/ID_Rifle.ID_Rifle_C"),
+		TEXT("/ShooterCore/Weapons/Pistol/ID_Pistol.ID_Pistol_C"),
+		TEXT("/ShooterCore/Weapons/Shotgun/ID_Shotgun.ID_Shotgun_C"),
+	};
+
+	// How long to wait for the experience and bots before giving up
+	static const double SetupTimeoutSeconds = 120.0;
+}
+
+void ULyraTestControllerWeaponFiring::OnInit()
+{
+	Super::OnInit();
+
+	FParse::Value(FCommandLine::Get(), TEXT("WeaponFiringFrames="), NumFiringFrames);
+	FParse::Value(FCommandLine::Get(), TEXT("WeaponFiringWarmUpFrames="), NumWarmUpFrames);
+	FParse::Value(FCommandLine::Get(), TEXT("WeaponFiringBots="), MinNumBots);
+	NumFiringFrames = FMath::Max(NumFiringFrames, 1);
+	NumWarmUpFrames = FMath::Max(NumWarmUpFrames, 0);
+	// Bots are split evenly between two teams and each one fires at the next, so keep the count even
+	MinNumBots = FMath::Max(Align(MinNumBots, 2), 2);
+
+	TArray<FString> ItemPaths;
+	FString ItemsFromCommandLine;
+	if (FParse::Value(FCommandLine::Get(), TEXT("WeaponFiringItems="), ItemsFromCommandLine, /*bShouldStopOnSeparator=*/ false))
+	{
+		ItemsFromCommandLine.ParseIntoArray(ItemPaths, TEXT(","));
+	}
+	else
+	{
+		ItemPaths.Append(LyraWeaponFiringTest::DefaultWeaponItems, UE_ARRAY_COUNT(LyraWeaponFiringTest::DefaultWeaponItems));
+	}
+
+	for (const FString& ItemPath : ItemPaths)
+	{
+		TSoftClassPtr<ULyraInventoryItemDefinition> SoftItemDef{FSoftObjectPath(ItemPath)};
+		if (TSubclassOf<ULyraInventoryItemDefinition> ItemDef = SoftItemDef.LoadSynchronous())
+		{
+			WeaponItems.Add(ItemDef);
+		}
+		else
+		{
+			UE_LOG(LogLyra, Error, TEXT("WeaponFiring: Failed to load weapon item definition '%s'"), *ItemPath);
+		}
+	}
+
+	Phase = EPhase::WaitingForExperience;
+}
+
+void ULyraTestControllerWeaponFiring::OnTick(float TimeDelta)
+{
+	Super::OnTick(TimeDelta);
+
+	++FramesInPhase;
+
+	switch (Phase)
+	{
+	case EPhase::WaitingForExperience:
+		if (IsExperienceLoaded())
+		{
+			Phase = EPhase::SpawningBots;
+			FramesInPhase = 0;
+		}
+		else if (GetTimeInCurrentState() > LyraWeaponFiringTest::SetupTimeoutSeconds)
+		{
+			UE_LOG(LogLyra, Error, TEXT("WeaponFiring: Timed out waiting for the experience to load"));
+			EndTest(1);
+			Phase = EPhase::Finished;
+		}
+		break;
+
+	case EPhase::SpawningBots:
+		GatherBots();
+		if (Bots.Num() >= MinNumBots)
+		{
+			if (WeaponItems.Num() == 0)
+			{
+				UE_LOG(LogLyra, Error, TEXT("WeaponFiring: No weapons to test"));
+				EndTest(1);
+				Phase = EPhase::Finished;
+				break;
+			}
+
+			AssignBotTeams();
+			EquipWeaponOnBots(WeaponItems[CurrentWeaponIndex]);
+			Phase = EPhase::WarmingUp;
+			FramesInPhase = 0;
+		}
+		else if (GetTimeInCurrentState() > LyraWeaponFiringTest::SetupTimeoutSeconds)
+		{
+			UE_LOG(LogLyra, Error, TEXT("WeaponFiring: Timed out waiting for %d bots (have %d)"), MinNumBots, Bots.Num());
+			EndTest(1);
+			Phase = EPhase::Finished;
+		}
+		break;
+
+	case EPhase::WarmingUp:
+		if (FramesInPhase >= NumWarmUpFrames)
+		{
+			BeginCapture();
+			Phase = EPhase::Firing;
+			FramesInPhase = 0;
+		}
+		break;
+
+	case EPhase::Firing:
+		FireWeaponsOnBots();
+		if (FramesInPhase >= NumFiringFrames)
+		{
+			EndCapture();
+
+			++CurrentWeaponIndex;
+			if (WeaponItems.IsValidIndex(CurrentWeaponIndex))
+			{
+				EquipWeaponOnBots(WeaponItems[CurrentWeaponIndex]);
+				Phase = EPhase::WarmingUp;
+				FramesInPhase = 0;
+			}
+			else
+			{
+				WriteResults();
+				EndTest(0);
+				Phase = EPhase::Finished;
+			}
+		}
+		break;
+
+	case EPhase::Finished:
+		break;
+	}
+}
+
+bool ULyraTestControllerWeaponFiring::IsExperienceLoaded() const
+{
+	if (const UWorld* World = GetWorld())
+	{
+		if (const AGameStateBase* GameState = World->GetGameState())
+		{
+			if (const ULyraExperienceManagerComponent* ExperienceComponent = GameState->FindComponentByClass<ULyraExperienceManagerComponent>())
+			{
+				return ExperienceComponent->IsExperienceLoaded();
+			}
+		}
+	}
+
+	return false;
+}
+
+void ULyraTestControllerWeaponFiring::GatherBots()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	Bots.Reset();
+	int32 NumControllers = 0;
+	for (TActorIterator<AAIController> It(World); It; ++It)
+	{
+		++NumControllers;
+		if (It->GetPawn() != nullptr)
+		{
+			Bots.Add(*It);
+		}
+	}
+
+#if WITH_SERVER_CODE
+	// Top up the bot count once if the experience didn't create enough, then wait for their pawns to spawn
+	if (!bRequestedBots)
+	{
+		bRequestedBots = true;
+
+		if (AGameStateBase* GameState = World->GetGameState())
+		{
+			if (ULyraBotCreationComponent* BotComponent = GameState->FindComponentByClass<ULyraBotCreationComponent>())
+			{
+				for (int32 Count = NumControllers; Count < MinNumBots; ++Count)
+				{
+					BotComponent->Cheat_AddBot();
+				}
+			}
+		}
+	}
+#endif
+}
+
+void ULyraTestControllerWeaponFiring::AssignBotTeams()
+{
+	// Only fire with an even number of bots, so alternating teams always puts each bot's target on the other team
+	Bots.SetNum(Bots.Num() & ~1);
+
+#if WITH_SERVER_CODE
+	ULyraTeamSubsystem* TeamSubsystem = (GetWorld() != nullptr) ? GetWorld()->GetSubsystem<ULyraTeamSubsystem>() : nullptr;
+	TArray<int32> TeamIDs = (TeamSubsystem != nullptr) ? TeamSubsystem->GetTeamIDs() : TArray<int32>();
+	if (TeamIDs.Num() < 2)
+	{
+		UE_LOG(LogLyra, Warning, TEXT("WeaponFiring: The experience has %d team(s), bots may not be able to damage each other"), TeamIDs.Num());
+		return;
+	}
+
+	TeamIDs.Sort();
+	for (int32 BotIndex = 0; BotIndex < Bots.Num(); ++BotIndex)
+	{
+		if (AAIController* Bot = Bots[BotIndex].Get())
+		{
+			TeamSubsystem->ChangeTeamForActor(Bot, TeamIDs[BotIndex % 2]);
+		}
+	}
+#endif
+}
+
+void ULyraTestControllerWeaponFiring::EquipWeaponOnBots(TSubclassOf<ULyraInventoryItemDefinition> ItemDef)
+{
+	for (const TWeakObjectPtr<AAIController>& WeakBot : Bots)
+	{
+		AAIController* Bot = WeakBot.Get();
+		if (Bot == nullptr)
+		{
+			continue;
+		}
+
+		// Keep the bots still so every weapon is measured under the same conditions
+		if (UBrainComponent* Brain = Bot->GetBrainComponent())
+		{
+			Brain->StopLogic(TEXT("WeaponFiringTest"));
+		}
+
+		ULyraInventoryManagerComponent* Inventory = Bot->FindComponentByClass<ULyraInventoryManagerComponent>();
+		ULyraQuickBarComponent* QuickBar = Bot->FindComponentByClass<ULyraQuickBarComponent>();
+		if ((Inventory == nullptr) || (QuickBar == nullptr))
+		{
+			continue;
+		}
+
+		// Replace whatever is in the first slot with the weapon under test
+		const int32 SlotIndex = 0;
+		if (ULyraInventoryItemInstance* OldItem = QuickBar->RemoveItemFromSlot(SlotIndex))
+		{
+			Inventory->RemoveItemInstance(OldItem);
+		}
+
+		if (ULyraInventoryItemInstance* NewItem = Inventory->AddItemDefinition(ItemDef))
+		{
+			QuickBar->AddItemToSlot(SlotIndex, NewItem);
+			QuickBar->SetActiveSlotIndex(SlotIndex);
+		}
+	}
+}
+
+void ULyraTestControllerWeaponFiring::FireWeaponsOnBots()
+{
+	for (int32 BotIndex = 0; BotIndex < Bots.Num(); ++BotIndex)
+	{
+		AAIController* Bot = Bots[BotIndex].Get();
+		APawn* Pawn = (Bot != nullptr) ? Bot->GetPawn() : nullptr;
+		if (Pawn == nullptr)
+		{
+			continue;
+		}
+
+		// Each bot shoots at the next one, which is on the other team (see AssignBotTeams)
+		if (AAIController* TargetBot = Bots[(BotIndex + 1) % Bots.Num()].Get())
+		{
+			Bot->SetFocus(TargetBot->GetPawn());
+		}
+
+		ULyraEquipmentManagerComponent* EquipmentManager = Pawn->FindComponentByClass<ULyraEquipmentManagerComponent>();
+		ULyraRangedWeaponInstance* Weapon = (EquipmentManager != nullptr) ? EquipmentManager->GetFirstInstanceOfType<ULyraRangedWeaponInstance>() : nullptr;
+		UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Pawn);
+		if ((Weapon == nullptr) || (ASC == nullptr))
+		{
+			continue;
+		}
+
+		for (const FGameplayAbilitySpec& Spec : ASC->GetActivatableAbilities())
+		{
+			if ((Spec.SourceObject == Weapon) && !Spec.IsActive() && Spec.Ability && Spec.Ability->IsA<ULyraGameplayAbility_RangedWeapon>())
+			{
+				ASC->TryActivateAbility(Spec.Handle);
+				break;
+			}
+		}
+	}
+}
+
+void ULyraTestControllerWeaponFiring::BeginCapture()
+{
+	FLyraWeaponFiringStats::Get().BeginCapture();
+	CaptureStartAllocations = GetTotalAllocationCount();
+	CaptureStartNetBytesOut = GetNetBytesOut();
+}
+
+void ULyraTestControllerWeaponFiring::EndCapture()
+{
+	FLyraWeaponFiringStats& Stats = FLyraWeaponFiringStats::Get();
+	Stats.EndCapture();
+
+	FWeaponResult& Result = Results.AddDefaulted_GetRef();
+	Result.WeaponName = GetNameSafe(WeaponItems[CurrentWeaponIndex]);
+	Result.NumFrames = NumFiringFrames;
+	Result.NumShots = Stats.GetNumShots();
+	Result.NumBullets = Stats.GetNumBullets();
+	Result.NumAllocations = GetTotalAllocationCount() - CaptureStartAllocations;
+	Result.NetBytesOut = GetNetBytesOut() - CaptureStartNetBytesOut;
+
+	for (int32 StageIndex = 0; StageIndex < (int32)ELyraWeaponFiringStage::Count; ++StageIndex)
+	{
+		const FLyraWeaponFiringStats::FStageTotals& Totals = Stats.GetStageTotals((ELyraWeaponFiringStage)StageIndex);
+		Result.StageMicroseconds[StageIndex] = FPlatformTime::ToMilliseconds64(Totals.Cycles) * 1000.0;
+		Result.StageCalls[StageIndex] = Totals.Calls;
+	}
+
+	UE_LOG(LogLyra, Display, TEXT("WeaponFiring: %s fired %d shots (%d bullets) over %d frames"), *Result.WeaponName, Result.NumShots, Result.NumBullets, Result.NumFrames);
+}
+
+void ULyraTestControllerWeaponFiring::WriteResults()
+{
+	FString Csv = TEXT("Weapon,Frames,Shots,Bullets");
+	for (int32 StageIndex = 0; StageIndex < (int32)ELyraWeaponFiringStage::Count; ++StageIndex)
+	{
+		Csv += FString::Printf(TEXT(",%s_us_per_shot,%s_calls"), FLyraWeaponFiringStats::GetStageName((ELyraWeaponFiringStage)StageIndex), FLyraWeaponFiringStats::GetStageName((ELyraWeaponFiringStage)StageIndex));
+	}
+	Csv += TEXT(",Allocations_per_shot,NetBytesOut_per_shot\n");
+
+	for (const FWeaponResult& Result : Results)
+	{
+		const double ShotDivisor = FMath::Max(Result.NumShots, 1);
+
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d"), *Result.WeaponName, Result.NumFrames, Result.NumShots, Result.NumBullets);
+		for (int32 StageIndex = 0; StageIndex < (int32)ELyraWeaponFiringStage::Count; ++StageIndex)
+		{
+			Csv += FString::Printf(TEXT(",%.3f,%d"), Result.StageMicroseconds[StageIndex] / ShotDivisor, Result.StageCalls[StageIndex]);
+		}
+		Csv += FString::Printf(TEXT(",%.2f,%.2f\n"), double(Result.NumAllocations) / ShotDivisor, double(Result.NetBytesOut) / ShotDivisor);
+	}
+
+	const FString OutputDir = FPaths::ProfilingDir() / TEXT("WeaponFiring");
+	IFileManager::Get().MakeDirectory(*OutputDir, /*Tree=*/ true);
+
+	const FString OutputFilename = OutputDir / FString::Printf(TEXT("WeaponFiring-%s.csv"), *FDateTime::Now().ToString());
+	if (FFileHelper::SaveStringToFile(Csv, *OutputFilename))
+	{
+		UE_LOG(LogLyra, Display, TEXT("WeaponFiring: Wrote results to %s"), *IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*OutputFilename));
+	}
+	else
+	{
+		UE_LOG(LogLyra, Error, TEXT("WeaponFiring: Failed to write results to %s"), *OutputFilename);
+	}
+}
+
+uint64 ULyraTestControllerWeaponFiring::GetTotalAllocationCount()
+{
+#if STATS
+	return FMalloc::TotalMallocCalls.load() + FMalloc::TotalReallocCalls.load();
+#else
+	return 0;
+#endif
+}
+
+uint64 ULyraTestControllerWeaponFiring::GetNetBytesOut() const
+{
+	const UWorld* World = GetWorld();
+	const UNetDriver* NetDriver = (World != nullptr) ? World->GetNetDriver() : nullptr;
+	return (NetDriver != nullptr) ? uint64(NetDriver->OutTotalBytes) : 0;
+}
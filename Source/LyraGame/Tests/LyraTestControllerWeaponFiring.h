@@ -0,0 +1,90 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "GauntletTestController.h"
+#include "Weapons/LyraWeaponFiringStats.h"
+
+#include "LyraTestControllerWeaponFiring.generated.h"
+
+class AAIController;
+class ULyraInventoryItemDefinition;
+class UObject;
+
+/**
+ * ULyraTestControllerWeaponFiring
+ *
+ * Headless weapon firing throughput benchmark, run with -gauntlet=LyraTestControllerWeaponFiring.
+ *
+ * For each weapon item definition, equips it on every bot, has the bots fire at each other for a fixed number
+ * of frames and records the per-shot cost of each stage of the firing pipeline (see FLyraWeaponFiringStats),
+ * along with allocations and outgoing network bytes. Results are written as CSV to the profiling directory.
+ *
+ * Command line options:
+ *   -WeaponFiringItems=<ItemDefClassPath>,...  Weapon item definitions to test (defaults to the rifle, pistol and shotgun)
+ *   -WeaponFiringFrames=<N>                    Number of frames to fire each weapon for (default 600)
+ *   -WeaponFiringWarmUpFrames=<N>              Number of frames to wait after equipping before capturing (default 60)
+ *   -WeaponFiringBots=<N>                      Minimum number of bots to fire with, rounded up to an even count (default 4)
+ */
+UCLASS()
+class ULyraTestControllerWeaponFiring : public UGauntletTestController
+{
+	GENERATED_BODY()
+
+protected:
+	//~UGauntletTestController interface
+	virtual void OnInit() override;
+	virtual void OnTick(float TimeDelta) override;
+	//~End of UGauntletTestController interface
+
+private:
+	enum class EPhase : uint8
+	{
+		WaitingForExperience,
+		SpawningBots,
+		WarmingUp,
+		Firing,
+		Finished
+	};
+
+	struct FWeaponResult
+	{
+		FString WeaponName;
+		int32 NumFrames = 0;
+		int32 NumShots = 0;
+		int32 NumBullets = 0;
+		double StageMicroseconds[(int32)ELyraWeaponFiringStage::Count] = {};
+		int32 StageCalls[(int32)ELyraWeaponFiringStage::Count] = {};
+		uint64 NumAllocations = 0;
+		uint64 NetBytesOut = 0;
+	};
+
+	bool IsExperienceLoaded() const;
+	void GatherBots();
+	void AssignBotTeams();
+	void EquipWeaponOnBots(TSubclassOf<ULyraInventoryItemDefinition> ItemDef);
+	void FireWeaponsOnBots();
+	void BeginCapture();
+	void EndCapture();
+	void WriteResults();
+
+	static uint64 GetTotalAllocationCount();
+	uint64 GetNetBytesOut() const;
+
+private:
+	TArray<TSubclassOf<ULyraInventoryItemDefinition>> WeaponItems;
+	TArray<TWeakObjectPtr<AAIController>> Bots;
+	TArray<FWeaponResult> Results;
+
+	EPhase Phase = EPhase::WaitingForExperience;
+	int32 CurrentWeaponIndex = 0;
+	int32 FramesInPhase = 0;
+	bool bRequestedBots = false;
+
+	int32 NumFiringFrames = 600;
+	int32 NumWarmUpFrames = 60;
+	int32 MinNumBots = 4;
+
+	uint64 CaptureStartAllocations = 0;
+	uint64 CaptureStartNetBytesOut = 0;
+};
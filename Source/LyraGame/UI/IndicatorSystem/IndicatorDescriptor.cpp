@@ -122,6 +122,128 @@ bool FIndicatorProjection::Project(const UIndicatorDescriptor& IndicatorDescript
 	return false;
 }
 
+void FIndicatorProjection::ProjectBatch(TConstArrayView<const UIndicatorDescriptor*> Indicators, const FSceneViewProjectionData& InProjectionData, const FVector2f& ScreenSize, TArray<FVector>& OutScreenPositionsWithDepth, TArray<bool>& OutSuccess)
+{
+	const int32 NumIndicators = Indicators.Num();
+	OutScreenPositionsWithDepth.SetNumUninitialized(NumIndicators);
+	OutSuccess.SetNumUninitialized(NumIndicators);
+
+	PointIndicatorIndices.Reset();
+	PointX.Reset();
+	PointY.Reset();
+	PointZ.Reset();
+
+	// Gather the world point for each indicator that projects a single point, relative to the view origin so the
+	// transform can be done in single precision anywhere in the world
+	const FVector ViewOrigin = InProjectionData.ViewOrigin;
+	for (int32 IndicatorIndex = 0; IndicatorIndex < NumIndicators; ++IndicatorIndex)
+	{
+		const UIndicatorDescriptor& IndicatorDescriptor = *Indicators[IndicatorIndex];
+		OutSuccess[IndicatorIndex] = false;
+
+		USceneComponent* Component = IndicatorDescriptor.GetSceneComponent();
+		if (Component == nullptr)
+		{
+			continue;
+		}
+
+		FVector ProjectWorldLocation;
+		const EActorCanvasProjectionMode ProjectionMode = IndicatorDescriptor.GetProjectionMode();
+		switch (ProjectionMode)
+		{
+			case EActorCanvasProjectionMode::ComponentPoint:
+			{
+				const FVector WorldLocation = (IndicatorDescriptor.GetComponentSocketName() != NAME_None)
+					? Component->GetSocketTransform(IndicatorDescriptor.GetComponentSocketName()).GetLocation()
+					: Component->GetComponentLocation();
+				ProjectWorldLocation = WorldLocation + IndicatorDescriptor.GetWorldPositionOffset();
+				break;
+			}
+			case EActorCanvasProjectionMode::ActorBoundingBox:
+			case EActorCanvasProjectionMode::ComponentBoundingBox:
+			{
+				const FBox IndicatorBox = (ProjectionMode == EActorCanvasProjectionMode::ActorBoundingBox)
+					? Component->GetOwner()->GetComponentsBoundingBox()
+					: Component->Bounds.GetBox();
+				ProjectWorldLocation = IndicatorBox.GetCenter() + (IndicatorBox.GetSize() * (IndicatorDescriptor.GetBoundingBoxAnchor() - FVector(0.5)));
+				break;
+			}
+			default:
+			{
+				// The screen bounding box modes need the whole box projected
+				OutSuccess[IndicatorIndex] = Project(IndicatorDescriptor, InProjectionData, ScreenSize, OutScreenPositionsWithDepth[IndicatorIndex]);
+				continue;
+			}
+		}
+
+		const FVector3f RelativeLocation(ProjectWorldLocation - ViewOrigin);
+		PointIndicatorIndices.Add(IndicatorIndex);
+		PointX.Add(RelativeLocation.X);
+		PointY.Add(RelativeLocation.Y);
+		PointZ.Add(RelativeLocation.Z);
+	}
+
+	const int32 NumPoints = PointIndicatorIndices.Num();
+	if (NumPoints == 0)
+	{
+		return;
+	}
+
+	PointScreenX.SetNumUninitialized(NumPoints);
+	PointScreenY.SetNumUninitialized(NumPoints);
+	PointDepth.SetNumUninitialized(NumPoints);
+	PointInFrontOfCamera.SetNumUninitialized(NumPoints);
+
+	// Same math as ULocalPlayer::GetPixelPoint, using the translated view projection matrix since the view origin
+	// has already been removed. This loop only touches contiguous arrays so it vectorizes.
+	const FMatrix44f M(InProjectionData.ViewRotationMatrix * InProjectionData.ProjectionMatrix);
+	const float* RESTRICT InX = PointX.GetData();
+	const float* RESTRICT InY = PointY.GetData();
+	const float* RESTRICT InZ = PointZ.GetData();
+	float* RESTRICT OutX = PointScreenX.GetData();
+	float* RESTRICT OutY = PointScreenY.GetData();
+	float* RESTRICT OutDepth = PointDepth.GetData();
+	uint8* RESTRICT OutInFront = PointInFrontOfCamera.GetData();
+	for (int32 PointIndex = 0; PointIndex < NumPoints; ++PointIndex)
+	{
+		const float X = InX[PointIndex];
+		const float Y = InY[PointIndex];
+		const float Z = InZ[PointIndex];
+
+		const float ClipX = X * M.M[0][0] + Y * M.M[1][0] + Z * M.M[2][0] + M.M[3][0];
+		const float ClipY = X * M.M[0][1] + Y * M.M[1][1] + Z * M.M[2][1] + M.M[3][1];
+		const float ClipW = X * M.M[0][3] + Y * M.M[1][3] + Z * M.M[2][3] + M.M[3][3];
+
+		// Points behind the camera are mirrored, the same as GetPixelPoint
+		const float InvW = 1.0f / FMath::Max(FMath::Abs(ClipW), UE_SMALL_NUMBER);
+		OutX[PointIndex] = (0.5f + ClipX * 0.5f * InvW) * ScreenSize.X;
+		OutY[PointIndex] = (0.5f - ClipY * 0.5f * InvW) * ScreenSize.Y;
+		OutDepth[PointIndex] = FMath::Sqrt(X * X + Y * Y + Z * Z);
+		OutInFront[PointIndex] = (ClipW > 0.0f) ? 1 : 0;
+	}
+
+	const FBox2f ScreenBox(FVector2f::Zero(), ScreenSize);
+	for (int32 PointIndex = 0; PointIndex < NumPoints; ++PointIndex)
+	{
+		const int32 IndicatorIndex = PointIndicatorIndices[PointIndex];
+		const UIndicatorDescriptor& IndicatorDescriptor = *Indicators[IndicatorIndex];
+		const bool bInFrontOfCamera = (PointInFrontOfCamera[PointIndex] != 0);
+
+		FVector2f ScreenSpacePosition(PointScreenX[PointIndex], PointScreenY[PointIndex]);
+		ScreenSpacePosition.X += IndicatorDescriptor.GetScreenSpaceOffset().X * (bInFrontOfCamera ? 1 : -1);
+		ScreenSpacePosition.Y += IndicatorDescriptor.GetScreenSpaceOffset().Y;
+
+		if (!bInFrontOfCamera && ScreenBox.IsInside(ScreenSpacePosition))
+		{
+			const FVector2f CenterToPosition = (ScreenSpacePosition - (ScreenSize / 2)).GetSafeNormal();
+			ScreenSpacePosition = (ScreenSize / 2) + CenterToPosition * ScreenSize;
+		}
+
+		OutScreenPositionsWithDepth[IndicatorIndex] = FVector(ScreenSpacePosition.X, ScreenSpacePosition.Y, PointDepth[PointIndex]);
+		OutSuccess[IndicatorIndex] = true;
+	}
+}
+
 void UIndicatorDescriptor::SetIndicatorManagerComponent(ULyraIndicatorManagerComponent* InManager)
 {
 	// Make sure nobody has set this.
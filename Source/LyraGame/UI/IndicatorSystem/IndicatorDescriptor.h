@@ -19,6 +19,24 @@ struct FSceneViewProjectionData;
 struct FIndicatorProjection
 {
 	bool Project(const UIndicatorDescriptor& IndicatorDescriptor, const FSceneViewProjectionData& InProjectionData, const FVector2f& ScreenSize, FVector& ScreenPositionWithDepth);
+
+	/**
+	 * Projects a batch of indicators, with results lining up with the Indicators array.
+	 * The single point modes (ComponentPoint and the world bounding box modes) are gathered into contiguous arrays
+	 * and transformed together with one view projection matrix, only the screen bounding box modes go through Project.
+	 */
+	void ProjectBatch(TConstArrayView<const UIndicatorDescriptor*> Indicators, const FSceneViewProjectionData& InProjectionData, const FVector2f& ScreenSize, TArray<FVector>& OutScreenPositionsWithDepth, TArray<bool>& OutSuccess);
+
+private:
+	// Scratch space for ProjectBatch, kept around to avoid reallocating every update
+	TArray<int32> PointIndicatorIndices;
+	TArray<float> PointX;
+	TArray<float> PointY;
+	TArray<float> PointZ;
+	TArray<float> PointScreenX;
+	TArray<float> PointScreenY;
+	TArray<float> PointDepth;
+	TArray<uint8> PointInFrontOfCamera;
 };
 
 UENUM(BlueprintType)
@@ -31,6 +49,17 @@ enum class EActorCanvasProjectionMode : uint8
 	ActorScreenBoundingBox
 };
 
+/** How often an indicator is re-projected to the screen, it is interpolated on screen in between */
+UENUM(BlueprintType)
+enum class EIndicatorUpdateTier : uint8
+{
+	EveryFrame,
+	Rate30Hz,
+	Rate10Hz,
+	// Only when the view moves or an update is requested, for indicators that don't move in the world
+	OnChange
+};
+
 /**
  * Describes and controls an active indicator.  It is highly recommended that your widget implements
  * IActorIndicatorWidget so that it can 'bind' to the associated data.
@@ -168,6 +197,26 @@ public:
 		BoundingBoxAnchor = InBoundingBoxAnchor;
 	}
 
+public:
+	// Update Properties
+	//=======================
+
+	// How often the indicator is projected, it can be demoted further by distance or being off-screen (see ULyraIndicatorManagerComponent)
+	UFUNCTION(BlueprintCallable)
+	EIndicatorUpdateTier GetUpdateTier() const { return UpdateTier; }
+	UFUNCTION(BlueprintCallable)
+	void SetUpdateTier(EIndicatorUpdateTier InUpdateTier)
+	{
+		UpdateTier = InUpdateTier;
+	}
+
+	// Forces the indicator to be projected on the next update, regardless of its update tier
+	UFUNCTION(BlueprintCallable)
+	void RequestUpdate()
+	{
+		bUpdateRequested = true;
+	}
+
 public:
 	// Sorting Properties
 	//=======================
@@ -200,6 +249,8 @@ private:
 	bool bOverrideScreenPosition = false;
 	UPROPERTY()
 	bool bAutoRemoveWhenIndicatorComponentIsNull = false;
+	UPROPERTY()
+	bool bUpdateRequested = false;
 
 	UPROPERTY()
 	EActorCanvasProjectionMode ProjectionMode = EActorCanvasProjectionMode::ComponentPoint;
@@ -207,6 +258,8 @@ private:
 	TEnumAsByte<EHorizontalAlignment> HAlignment = HAlign_Center;
 	UPROPERTY()
 	TEnumAsByte<EVerticalAlignment> VAlignment = VAlign_Center;
+	UPROPERTY()
+	EIndicatorUpdateTier UpdateTier = EIndicatorUpdateTier::EveryFrame;
 
 	UPROPERTY()
 	int32 Priority = 0;
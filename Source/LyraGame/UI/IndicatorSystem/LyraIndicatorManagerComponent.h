@@ -13,6 +13,15 @@ class UIndicatorDescriptor;
 class UObject;
 struct FFrame;
 
+/** What the actor canvas did with the indicators in its last update */
+struct FLyraIndicatorUpdateStats
+{
+	int32 NumVisible = 0;
+	int32 NumProjected = 0;
+	int32 NumInterpolated = 0;
+	int32 NumOverBudget = 0;
+};
+
 /**
  * @class ULyraIndicatorManagerComponent
  */
@@ -38,9 +47,32 @@ public:
 
 	const TArray<UIndicatorDescriptor*>& GetIndicators() const { return Indicators; }
 
+	const FLyraIndicatorUpdateStats& GetLastUpdateStats() const { return LastUpdateStats; }
+	void SetLastUpdateStats(const FLyraIndicatorUpdateStats& InStats) { LastUpdateStats = InStats; }
+
+public:
+	// Maximum number of indicators projected per update for this player, indicators that update every frame are
+	// always projected and the rest are deferred (and interpolated) once it is used up. 0 means no limit.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Indicator)
+	int32 IndicatorUpdateBudget = 0;
+
+	// Indicators farther than this update at 30 Hz at most, even if they ask for every frame (0 disables, e.g., 3000)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Indicator)
+	float Demote30HzDistance = 0.0f;
+
+	// Indicators farther than this update at 10 Hz at most, even if they ask for every frame (0 disables, e.g., 8000)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Indicator)
+	float Demote10HzDistance = 0.0f;
+
+	// Should indicators that are off-screen (or clamped to its edge) update at 10 Hz at most?
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Indicator)
+	bool bDemoteOffScreenIndicators = false;
+
 private:
 	UPROPERTY()
 	TArray<TObjectPtr<UIndicatorDescriptor>> Indicators;
+
+	FLyraIndicatorUpdateStats LastUpdateStats;
 };
 
 #undef UE_API
@@ -3,6 +3,7 @@
 #include "SActorCanvas.h"
 
 #include "Engine/GameViewportClient.h"
+#include "HAL/IConsoleManager.h"
 #include "IActorIndicatorWidget.h"
 #include "Layout/ArrangedChildren.h"
 #include "LyraIndicatorManagerComponent.h"
@@ -13,6 +14,54 @@
 
 class FSlateRect;
 
+namespace LyraIndicatorCVars
+{
+	static bool bBatchProjection = true;
+	static FAutoConsoleVariableRef CVarBatchProjection(
+		TEXT("Lyra.Indicators.BatchProjection"),
+		bBatchProjection,
+		TEXT("Should indicators be projected to the screen in one batch (instead of one at a time)?"),
+		ECVF_Default);
+
+	static float SortDepthBucketSize = 100.0f;
+	static FAutoConsoleVariableRef CVarSortDepthBucketSize(
+		TEXT("Lyra.Indicators.SortDepthBucketSize"),
+		SortDepthBucketSize,
+		TEXT("Indicators with the same priority are sorted by depth in buckets of this size (in cm), so small movements don't reorder them"),
+		ECVF_Default);
+
+	static bool bUseUpdateTiers = true;
+	static FAutoConsoleVariableRef CVarUseUpdateTiers(
+		TEXT("Lyra.Indicators.UseUpdateTiers"),
+		bUseUpdateTiers,
+		TEXT("Should indicators be projected at their update tier's rate and within the indicator budget (instead of every frame)?"),
+		ECVF_Default);
+
+	static float SnapViewRotationDegrees = 10.0f;
+	static FAutoConsoleVariableRef CVarSnapViewRotationDegrees(
+		TEXT("Lyra.Indicators.SnapViewRotationDegrees"),
+		SnapViewRotationDegrees,
+		TEXT("If the view turns by more than this many degrees in one frame, every indicator is projected that frame regardless of its update tier or the budget (0 disables)"),
+		ECVF_Default);
+}
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Indicators Projected"), STAT_LyraIndicatorsProjected, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Indicators Interpolated"), STAT_LyraIndicatorsInterpolated, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Indicators Over Budget"), STAT_LyraIndicatorsOverBudget, STATGROUP_Game);
+
+static double GetUpdateTierInterval(EIndicatorUpdateTier Tier)
+{
+	switch (Tier)
+	{
+	case EIndicatorUpdateTier::Rate30Hz:
+		return 1.0 / 30.0;
+	case EIndicatorUpdateTier::Rate10Hz:
+		return 1.0 / 10.0;
+	default:
+		return 0.0;
+	}
+}
+
 namespace EArrowDirection
 {
 	enum Type
@@ -202,6 +251,24 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 
 			bool IndicatorsChanged = false;
 
+			ProjectedSlotIndices.Reset();
+			ProjectedIndicators.Reset();
+			DeferrableSlotIndices.Reset();
+			InterpolatedSlotIndices.Reset();
+
+			const bool bUseUpdateTiers = LyraIndicatorCVars::bUseUpdateTiers;
+			const bool bViewChanged = !ProjectionData.ViewOrigin.Equals(LastViewOrigin) || !ProjectionData.ViewRotationMatrix.Equals(LastViewRotationMatrix) || (LastScreenSize != FVector2D(PaintGeometry.Size));
+
+			// A fast turn invalidates every prediction at once, so snap everything instead of letting demoted indicators drift
+			const bool bViewSnapped = bViewChanged && (LyraIndicatorCVars::SnapViewRotationDegrees > 0.0f)
+				&& (FMath::RadiansToDegrees(FQuat(ProjectionData.ViewRotationMatrix).AngularDistance(FQuat(LastViewRotationMatrix))) > LyraIndicatorCVars::SnapViewRotationDegrees);
+
+			LastViewOrigin = ProjectionData.ViewOrigin;
+			LastViewRotationMatrix = ProjectionData.ViewRotationMatrix;
+			LastScreenSize = FVector2D(PaintGeometry.Size);
+
+			FLyraIndicatorUpdateStats UpdateStats;
+
 			for (int32 ChildIndex = 0; ChildIndex < CanvasChildren.Num(); ++ChildIndex)
 			{
 				SActorCanvas::FSlot& CurChild = CanvasChildren[ChildIndex];
@@ -222,11 +289,16 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 
 				if (!CurChild.GetIsIndicatorVisible())
 				{
+					// Project it again as soon as it is shown
+					CurChild.bHasProjection = false;
+
 					IndicatorsChanged |= CurChild.bIsDirty();
 					CurChild.ClearDirtyFlag();
 					continue;
 				}
 
+				++UpdateStats.NumVisible;
+
 				// If the indicator changed clamp status between updates, alert the indicator and mark the indicators as changed
 				if (CurChild.WasIndicatorClampedStatusChanged())
 				{
@@ -235,13 +307,81 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 					IndicatorsChanged = true;
 				}
 
-				FVector ScreenPositionWithDepth;
+				// Removals only happen at the current index, so the indices gathered so far stay valid
+				if (!bUseUpdateTiers || bViewSnapped || !CurChild.bHasProjection || Indicator->bUpdateRequested)
+				{
+					ProjectedSlotIndices.Add(ChildIndex);
+					continue;
+				}
 
-				FIndicatorProjection Projector;
-				const bool Success = Projector.Project(*Indicator, ProjectionData, PaintGeometry.Size, OUT ScreenPositionWithDepth);
+				const EIndicatorUpdateTier UpdateTier = GetEffectiveUpdateTier(CurChild, *IndicatorComponent);
+				if (UpdateTier == EIndicatorUpdateTier::EveryFrame)
+				{
+					ProjectedSlotIndices.Add(ChildIndex);
+				}
+				else if ((UpdateTier == EIndicatorUpdateTier::OnChange) ? bViewChanged : (InCurrentTime >= CurChild.NextProjectionTime))
+				{
+					DeferrableSlotIndices.Add(ChildIndex);
+				}
+				else
+				{
+					InterpolatedSlotIndices.Add(ChildIndex);
+				}
+			}
+
+			// Spend what is left of the budget on the indicators that have been waiting the longest
+			const int32 UpdateBudget = IndicatorComponent->IndicatorUpdateBudget;
+			if ((UpdateBudget > 0) && ((ProjectedSlotIndices.Num() + DeferrableSlotIndices.Num()) > UpdateBudget))
+			{
+				DeferrableSlotIndices.Sort([this](int32 A, int32 B)
+				{
+					return CanvasChildren[A].NextProjectionTime < CanvasChildren[B].NextProjectionTime;
+				});
+
+				const int32 NumToProject = FMath::Clamp(UpdateBudget - ProjectedSlotIndices.Num(), 0, DeferrableSlotIndices.Num());
+				UpdateStats.NumOverBudget = DeferrableSlotIndices.Num() - NumToProject;
+				InterpolatedSlotIndices.Append(DeferrableSlotIndices.GetData() + NumToProject, UpdateStats.NumOverBudget);
+				DeferrableSlotIndices.SetNum(NumToProject, EAllowShrinking::No);
+			}
+			ProjectedSlotIndices.Append(DeferrableSlotIndices);
+
+			for (int32 SlotIndex : ProjectedSlotIndices)
+			{
+				ProjectedIndicators.Add(CanvasChildren[SlotIndex].Indicator);
+			}
+
+			// Project all the indicators that are due together
+			{
+				QUICK_SCOPE_CYCLE_COUNTER(STAT_SActorCanvas_ProjectIndicators);
+
+				if (LyraIndicatorCVars::bBatchProjection)
+				{
+					Projector.ProjectBatch(ProjectedIndicators, ProjectionData, PaintGeometry.Size, /*out*/ ProjectedScreenPositions, /*out*/ ProjectedSuccess);
+				}
+				else
+				{
+					ProjectedScreenPositions.SetNumUninitialized(ProjectedIndicators.Num());
+					ProjectedSuccess.SetNumUninitialized(ProjectedIndicators.Num());
+					for (int32 ProjectedIndex = 0; ProjectedIndex < ProjectedIndicators.Num(); ++ProjectedIndex)
+					{
+						ProjectedSuccess[ProjectedIndex] = Projector.Project(*ProjectedIndicators[ProjectedIndex], ProjectionData, PaintGeometry.Size, OUT ProjectedScreenPositions[ProjectedIndex]);
+					}
+				}
+			}
+
+			const FBox2D ScreenBox(FVector2D::ZeroVector, FVector2D(PaintGeometry.Size));
+			for (int32 ProjectedIndex = 0; ProjectedIndex < ProjectedSlotIndices.Num(); ++ProjectedIndex)
+			{
+				SActorCanvas::FSlot& CurChild = CanvasChildren[ProjectedSlotIndices[ProjectedIndex]];
+				UIndicatorDescriptor* Indicator = CurChild.Indicator;
+				const FVector& ScreenPositionWithDepth = ProjectedScreenPositions[ProjectedIndex];
+				const bool Success = ProjectedSuccess[ProjectedIndex];
+
+				Indicator->bUpdateRequested = false;
 
 				if (!Success)
 				{
+					CurChild.bHasProjection = false;
 					CurChild.SetHasValidScreenPosition(false);
 					CurChild.SetInFrontOfCamera(false);
 
@@ -255,9 +395,30 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 
 				if (CurChild.HasValidScreenPosition())
 				{
+					const FVector2D ScreenPosition(ScreenPositionWithDepth);
+					const EIndicatorUpdateTier UpdateTier = bUseUpdateTiers ? GetEffectiveUpdateTier(CurChild, *IndicatorComponent) : EIndicatorUpdateTier::EveryFrame;
+					const double UpdateInterval = GetUpdateTierInterval(UpdateTier);
+
+					// Show the new position right away, then keep it moving at the rate it moved since the last projection until the next one,
+					// so indicators on a slower tier lead their target instead of trailing it by a whole interval
+					FVector2D PredictedPosition = ScreenPosition;
+					const double TimeSinceLastProjection = InCurrentTime - CurChild.InterpStartTime;
+					if (CurChild.bHasProjection && (UpdateInterval > 0.0) && (TimeSinceLastProjection > 0.0) && !bViewSnapped)
+					{
+						PredictedPosition += (ScreenPosition - CurChild.InterpStartPosition) * (UpdateInterval / TimeSinceLastProjection);
+					}
+
+					CurChild.InterpStartPosition = ScreenPosition;
+					CurChild.InterpTargetPosition = PredictedPosition;
+					CurChild.InterpStartTime = InCurrentTime;
+					CurChild.InterpDuration = UpdateInterval;
+					CurChild.NextProjectionTime = InCurrentTime + UpdateInterval;
+					CurChild.bHasProjection = true;
+					CurChild.bOffScreen = !ScreenBox.IsInside(ScreenPosition);
+
 					// Only dirty the screen position if we can actually show this indicator.
-					CurChild.SetScreenPosition(FVector2D(ScreenPositionWithDepth));
-					CurChild.SetDepth(ScreenPositionWithDepth.X);
+					CurChild.SetScreenPosition(ScreenPosition);
+					CurChild.SetDepth(ScreenPositionWithDepth.Z, LyraIndicatorCVars::SortDepthBucketSize);
 				}
 
 				CurChild.SetPriority(Indicator->GetPriority());
@@ -266,6 +427,29 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 				CurChild.ClearDirtyFlag();
 			}
 
+			for (int32 SlotIndex : InterpolatedSlotIndices)
+			{
+				SActorCanvas::FSlot& CurChild = CanvasChildren[SlotIndex];
+
+				if (CurChild.HasValidScreenPosition())
+				{
+					const double Alpha = (CurChild.InterpDuration > 0.0) ? FMath::Clamp((InCurrentTime - CurChild.InterpStartTime) / CurChild.InterpDuration, 0.0, 1.0) : 1.0;
+					CurChild.SetScreenPosition(FMath::Lerp(CurChild.InterpStartPosition, CurChild.InterpTargetPosition, Alpha));
+				}
+
+				CurChild.SetPriority(CurChild.Indicator->GetPriority());
+
+				IndicatorsChanged |= CurChild.bIsDirty();
+				CurChild.ClearDirtyFlag();
+			}
+
+			UpdateStats.NumProjected = ProjectedSlotIndices.Num();
+			UpdateStats.NumInterpolated = InterpolatedSlotIndices.Num();
+			IndicatorComponent->SetLastUpdateStats(UpdateStats);
+			INC_DWORD_STAT_BY(STAT_LyraIndicatorsProjected, UpdateStats.NumProjected);
+			INC_DWORD_STAT_BY(STAT_LyraIndicatorsInterpolated, UpdateStats.NumInterpolated);
+			INC_DWORD_STAT_BY(STAT_LyraIndicatorsOverBudget, UpdateStats.NumOverBudget);
+
 			if (IndicatorsChanged)
 			{
 				Invalidate(EInvalidateWidget::Paint);
@@ -322,16 +506,7 @@ void SActorCanvas::OnArrangeChildren(const FGeometry& AllottedGeometry, FArrange
 		const FVector Center = FVector(AllottedGeometry.Size * 0.5f, 0.0f);
 
 		// Sort the children
-		TArray<const SActorCanvas::FSlot*> SortedSlots;
-		for (int32 ChildIndex = 0; ChildIndex < CanvasChildren.Num(); ++ChildIndex)
-		{
-			SortedSlots.Add(&CanvasChildren[ChildIndex]);
-		}
-
-		SortedSlots.StableSort([](const SActorCanvas::FSlot& A, const SActorCanvas::FSlot& B)
-		{
-			return A.GetPriority() == B.GetPriority() ? A.GetDepth() > B.GetDepth() : A.GetPriority() < B.GetPriority();
-		});
+		UpdateSortedSlots();
 
 		// Go through all the sorted children
 		for (int32 ChildIndex = 0; ChildIndex < SortedSlots.Num(); ++ChildIndex)
@@ -501,6 +676,114 @@ void SActorCanvas::OnArrangeChildren(const FGeometry& AllottedGeometry, FArrange
 	ArrowIndexLastUpdate = NextArrowIndex;
 }
 
+EIndicatorUpdateTier SActorCanvas::GetEffectiveUpdateTier(const FSlot& Slot, const ULyraIndicatorManagerComponent& IndicatorComponent) const
+{
+	const EIndicatorUpdateTier UpdateTier = Slot.Indicator->GetUpdateTier();
+	if (UpdateTier == EIndicatorUpdateTier::OnChange)
+	{
+		return UpdateTier;
+	}
+
+	EIndicatorUpdateTier DemotedTier = UpdateTier;
+	if (IndicatorComponent.bDemoteOffScreenIndicators && (Slot.bOffScreen || !Slot.GetInFrontOfCamera()))
+	{
+		DemotedTier = EIndicatorUpdateTier::Rate10Hz;
+	}
+	else if ((IndicatorComponent.Demote10HzDistance > 0.0f) && (Slot.GetDepth() > IndicatorComponent.Demote10HzDistance))
+	{
+		DemotedTier = EIndicatorUpdateTier::Rate10Hz;
+	}
+	else if ((IndicatorComponent.Demote30HzDistance > 0.0f) && (Slot.GetDepth() > IndicatorComponent.Demote30HzDistance))
+	{
+		DemotedTier = EIndicatorUpdateTier::Rate30Hz;
+	}
+
+	return FMath::Max(UpdateTier, DemotedTier);
+}
+
+bool SActorCanvas::SortSlotPredicate(const FSlot& A, const FSlot& B)
+{
+	if (A.GetPriority() != B.GetPriority())
+	{
+		return A.GetPriority() < B.GetPriority();
+	}
+
+	// Farther indicators first, then in the order they were added so indicators in the same bucket keep their order
+	if (A.SortDepthBucket != B.SortDepthBucket)
+	{
+		return A.SortDepthBucket > B.SortDepthBucket;
+	}
+
+	return A.SortSequence < B.SortSequence;
+}
+
+void SActorCanvas::UpdateSortedSlots() const
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_SActorCanvas_UpdateSortedSlots);
+
+	auto IsSlotShown = [](const FSlot& Slot)
+	{
+		return Slot.GetIsIndicatorVisible() && Slot.HasValidScreenPosition();
+	};
+
+	// Pull out the slots whose sort key changed or that went off-screen, what remains is still in order
+	SortedSlots.RemoveAll([&IsSlotShown](const FSlot* Slot)
+	{
+		if (!IsSlotShown(*Slot))
+		{
+			// Culled slots are no longer arranged, so they aren't clamped either
+			Slot->SetWasIndicatorClamped(false);
+			Slot->bInSortedSlots = false;
+			return true;
+		}
+		if (Slot->bSortKeyDirty)
+		{
+			Slot->bInSortedSlots = false;
+			return true;
+		}
+		return false;
+	});
+
+	ChangedSlots.Reset();
+	for (int32 ChildIndex = 0; ChildIndex < CanvasChildren.Num(); ++ChildIndex)
+	{
+		const FSlot& Slot = CanvasChildren[ChildIndex];
+		if (!Slot.bInSortedSlots && IsSlotShown(Slot))
+		{
+			Slot.bInSortedSlots = true;
+			Slot.bSortKeyDirty = false;
+			ChangedSlots.Add(&Slot);
+		}
+	}
+
+	if (ChangedSlots.Num() == 0)
+	{
+		return;
+	}
+
+	ChangedSlots.Sort([](const FSlot& A, const FSlot& B) { return SortSlotPredicate(A, B); });
+
+	// Merge the re-sorted slots back in
+	MergedSlots.Reset(SortedSlots.Num() + ChangedSlots.Num());
+	int32 SortedIndex = 0;
+	int32 ChangedIndex = 0;
+	while ((SortedIndex < SortedSlots.Num()) && (ChangedIndex < ChangedSlots.Num()))
+	{
+		if (SortSlotPredicate(*ChangedSlots[ChangedIndex], *SortedSlots[SortedIndex]))
+		{
+			MergedSlots.Add(ChangedSlots[ChangedIndex++]);
+		}
+		else
+		{
+			MergedSlots.Add(SortedSlots[SortedIndex++]);
+		}
+	}
+	MergedSlots.Append(SortedSlots.GetData() + SortedIndex, SortedSlots.Num() - SortedIndex);
+	MergedSlots.Append(ChangedSlots.GetData() + ChangedIndex, ChangedSlots.Num() - ChangedIndex);
+
+	Swap(SortedSlots, MergedSlots);
+}
+
 int32 SActorCanvas::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
 {
 	QUICK_SCOPE_CYCLE_COUNTER(STAT_SActorCanvas_OnPaint);
@@ -625,8 +908,11 @@ void SActorCanvas::RemoveIndicatorForEntry(UIndicatorDescriptor* Indicator)
 
 SActorCanvas::FScopedWidgetSlotArguments SActorCanvas::AddActorSlot(UIndicatorDescriptor* Indicator)
 {
+	TUniquePtr<FSlot> NewSlot = MakeUnique<FSlot>(Indicator);
+	NewSlot->SortSequence = NextSlotSortSequence++;
+
 	TWeakPtr<SActorCanvas> WeakCanvas = SharedThis(this);
-	return FScopedWidgetSlotArguments{ MakeUnique<FSlot>(Indicator), this->CanvasChildren, INDEX_NONE
+	return FScopedWidgetSlotArguments{ MoveTemp(NewSlot), this->CanvasChildren, INDEX_NONE
 		, [WeakCanvas](const FSlot*, int32)
 		{
 			if (TSharedPtr<SActorCanvas> Canvas = WeakCanvas.Pin())
@@ -642,6 +928,7 @@ int32 SActorCanvas::RemoveActorSlot(const TSharedRef<SWidget>& SlotWidget)
 	{
 		if ( SlotWidget == CanvasChildren[SlotIdx].GetWidget() )
 		{
+			SortedSlots.Remove(&CanvasChildren[SlotIdx]);
 			CanvasChildren.RemoveAt(SlotIdx);
 
 			UpdateActiveTimer();
@@ -4,6 +4,7 @@
 
 #include "AsyncMixin.h"
 #include "Blueprint/UserWidgetPool.h"
+#include "UI/IndicatorSystem/IndicatorDescriptor.h"
 #include "Widgets/SPanel.h"
 
 class FActiveTimerHandle;
@@ -38,6 +39,17 @@ public:
 			, bDirty(true)
 			, bWasIndicatorClamped(false)
 			, bWasIndicatorClampedStatusChanged(false)
+			, SortDepthBucket(0)
+			, SortSequence(0)
+			, bSortKeyDirty(true)
+			, bInSortedSlots(false)
+			, InterpStartPosition(FVector2D::ZeroVector)
+			, InterpTargetPosition(FVector2D::ZeroVector)
+			, InterpStartTime(0.0)
+			, InterpDuration(0.0)
+			, NextProjectionTime(0.0)
+			, bHasProjection(false)
+			, bOffScreen(false)
 		{
 		}
 
@@ -68,12 +80,20 @@ public:
 		}
 
 		double GetDepth() const { return Depth; }
-		void SetDepth(double InDepth)
+		void SetDepth(double InDepth, double SortDepthBucketSize)
 		{
 			if (Depth != InDepth)
 			{
 				Depth = InDepth;
 				bDirty = true;
+
+				// Only re-sort when the depth moves to another bucket, so small movements don't reorder indicators
+				const int32 NewSortDepthBucket = (SortDepthBucketSize > 0.0) ? FMath::FloorToInt32(InDepth / SortDepthBucketSize) : 0;
+				if (SortDepthBucket != NewSortDepthBucket)
+				{
+					SortDepthBucket = NewSortDepthBucket;
+					bSortKeyDirty = true;
+				}
 			}
 		}
 
@@ -84,6 +104,7 @@ public:
 			{
 				Priority = InPriority;
 				bDirty = true;
+				bSortKeyDirty = true;
 			}
 		}
 
@@ -159,6 +180,21 @@ public:
 		mutable uint8 bWasIndicatorClamped : 1;
 		mutable uint8 bWasIndicatorClampedStatusChanged : 1;
 
+		/** Sort order bookkeeping for SActorCanvas::SortedSlots, maintained during the const arrange pass */
+		int32 SortDepthBucket;
+		uint32 SortSequence;
+		mutable uint8 bSortKeyDirty : 1;
+		mutable uint8 bInSortedSlots : 1;
+
+		/** Update tier bookkeeping, the screen position is extrapolated from the last projection (InterpStartPosition) toward where it is predicted to be at the next one */
+		FVector2D InterpStartPosition;
+		FVector2D InterpTargetPosition;
+		double InterpStartTime;
+		double InterpDuration;
+		double NextProjectionTime;
+		uint8 bHasProjection : 1;
+		uint8 bOffScreen : 1;
+
 		friend class SActorCanvas;
 	};
 
@@ -224,6 +260,14 @@ private:
 
 	void UpdateActiveTimer();
 
+	/** Returns the tier the slot's indicator updates at, after demotion for distance or being off-screen */
+	EIndicatorUpdateTier GetEffectiveUpdateTier(const FSlot& Slot, const ULyraIndicatorManagerComponent& IndicatorComponent) const;
+
+	/** Brings SortedSlots up to date, only re-sorting the slots that changed since the last arrange */
+	void UpdateSortedSlots() const;
+
+	static bool SortSlotPredicate(const FSlot& A, const FSlot& B);
+
 private:
 	TArray<TObjectPtr<UIndicatorDescriptor>> AllIndicators;
 	TArray<UIndicatorDescriptor*> InactiveIndicators;
@@ -238,6 +282,26 @@ private:
 
 	FUserWidgetPool IndicatorPool;
 
+	/** Projects the visible indicators each update, along with scratch arrays reused between updates */
+	FIndicatorProjection Projector;
+	TArray<int32> ProjectedSlotIndices;
+	TArray<const UIndicatorDescriptor*> ProjectedIndicators;
+	TArray<FVector> ProjectedScreenPositions;
+	TArray<bool> ProjectedSuccess;
+	TArray<int32> DeferrableSlotIndices;
+	TArray<int32> InterpolatedSlotIndices;
+
+	/** The view from the last update, for indicators that only update when it changes */
+	FVector LastViewOrigin = FVector::ZeroVector;
+	FMatrix LastViewRotationMatrix = FMatrix::Identity;
+	FVector2D LastScreenSize = FVector2D::ZeroVector;
+
+	/** The visible slots in the order they are arranged, maintained incrementally by UpdateSortedSlots */
+	mutable TArray<const FSlot*> SortedSlots;
+	mutable TArray<const FSlot*> ChangedSlots;
+	mutable TArray<const FSlot*> MergedSlots;
+	uint32 NextSlotSortSequence = 0;
+
 	const FSlateBrush* ActorCanvasArrowBrush = nullptr;
 
 	mutable int32 NextArrowIndex = 0;
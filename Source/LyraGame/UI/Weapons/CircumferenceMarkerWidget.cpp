@@ -11,7 +11,6 @@ UCircumferenceMarkerWidget::UCircumferenceMarkerWidget(const FObjectInitializer&
 	: Super(ObjectInitializer)
 {
 	SetVisibility(ESlateVisibility::HitTestInvisible);
-	bIsVolatile = true;
 }
 
 void UCircumferenceMarkerWidget::ReleaseSlateResources(bool bReleaseChildren)
@@ -13,7 +13,6 @@ UHitMarkerConfirmationWidget::UHitMarkerConfirmationWidget(const FObjectInitiali
 	: Super(ObjectInitializer)
 {
 	SetVisibility(ESlateVisibility::HitTestInvisible);
-	bIsVolatile = true;
 	AnyHitsMarkerImage.DrawAs = ESlateBrushDrawType::NoDrawType;
 }
 
@@ -45,6 +45,29 @@ FSlateRenderTransform SCircumferenceMarkerWidget::GetMarkerRenderTransform(const
 	return TransformCast<FSlateRenderTransform>(Concatenate(RotateAboutOrigin, FVector2D(XRadius * FMath::Sin(PositionAngleRadians) * HUDScale, -YRadius * FMath::Cos(PositionAngleRadians) * HUDScale)));
 }
 
+void SCircumferenceMarkerWidget::UpdateMarkerTransforms(const float BaseRadius, const float HUDScale) const
+{
+	if ((MarkerTransforms.Num() == MarkerList.Num()) && (MarkerTransformsRadius == BaseRadius) && (MarkerTransformsScale == HUDScale))
+	{
+		return;
+	}
+
+	MarkerTransforms.Reset(MarkerList.Num());
+	for (const FCircumferenceMarkerEntry& Marker : MarkerList)
+	{
+		MarkerTransforms.Add(GetMarkerRenderTransform(Marker, BaseRadius, HUDScale));
+	}
+
+	MarkerTransformsRadius = BaseRadius;
+	MarkerTransformsScale = HUDScale;
+}
+
+bool SCircumferenceMarkerWidget::ComputeVolatility() const
+{
+	// SetRadius and SetMarkerList invalidate when they change anything, bound attributes can change at any time though
+	return Radius.IsBound() || ColorAndOpacity.IsBound();
+}
+
 int32 SCircumferenceMarkerWidget::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
 {
 	const bool bIsEnabled = ShouldBeEnabled(bParentEnabled);
@@ -63,10 +86,10 @@ int32 SCircumferenceMarkerWidget::OnPaint(const FPaintArgs& Args, const FGeometr
 		{
 			const float BaseRadius = Radius.Get();
 			const float ApplicationScale = GetDefault<UUserInterfaceSettings>()->ApplicationScale;
-			for (const FCircumferenceMarkerEntry& Marker : MarkerList)
-			{
-				const FSlateRenderTransform MarkerTransform = GetMarkerRenderTransform(Marker, BaseRadius, ApplicationScale);
+			UpdateMarkerTransforms(BaseRadius, ApplicationScale);
 
+			for (const FSlateRenderTransform& MarkerTransform : MarkerTransforms)
+			{
 				const FPaintGeometry Geometry(AllottedGeometry.ToPaintGeometry(MarkerBrush->ImageSize, FSlateLayoutTransform(LocalCenter - (MarkerBrush->ImageSize * 0.5f)), MarkerTransform, FVector2D(0.0f, 0.0f)));
 				FSlateDrawElement::MakeBox(OutDrawElements, LayerId, Geometry, MarkerBrush, DrawEffects, MarkerColor);
 			}
@@ -94,6 +117,11 @@ void SCircumferenceMarkerWidget::SetRadius(float NewRadius)
 
 void SCircumferenceMarkerWidget::SetMarkerList(TArray<FCircumferenceMarkerEntry>& NewMarkerList)
 {
-	MarkerList = NewMarkerList;
+	if (MarkerList != NewMarkerList)
+	{
+		MarkerList = NewMarkerList;
+		MarkerTransforms.Reset();
+		Invalidate(EInvalidateWidgetReason::Paint);
+	}
 }
 
@@ -28,6 +28,11 @@ struct FCircumferenceMarkerEntry
 	// The angle to rotate the marker image (in degrees)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ForceUnits=deg))
 	float ImageRotationAngle = 0.0f;
+
+	bool operator==(const FCircumferenceMarkerEntry& Other) const
+	{
+		return (PositionAngle == Other.PositionAngle) && (ImageRotationAngle == Other.ImageRotationAngle);
+	}
 };
 
 class SCircumferenceMarkerWidget : public SLeafWidget
@@ -55,7 +60,7 @@ public:
 	//~SWidget interface
 	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
 	virtual FVector2D ComputeDesiredSize(float) const override;
-	virtual bool ComputeVolatility() const override { return true; }
+	virtual bool ComputeVolatility() const override;
 	//~End of SWidget interface
 
 	void SetRadius(float NewRadius);
@@ -64,6 +69,9 @@ public:
 private:
 	FSlateRenderTransform GetMarkerRenderTransform(const FCircumferenceMarkerEntry& Marker, const float BaseRadius, const float HUDScale) const;
 
+	/** Recomputes the marker transforms if the radius or scale changed since they were last computed */
+	void UpdateMarkerTransforms(const float BaseRadius, const float HUDScale) const;
+
 private:
 	/** What each marker on the circumference looks like */
 	const FSlateBrush* MarkerBrush;
@@ -71,6 +79,11 @@ private:
 	/** Angles around the reticle center to place ReticleCornerImage icons */
 	TArray<FCircumferenceMarkerEntry> MarkerList;
 
+	/** Render transform of each marker, cached until the markers, radius or scale change */
+	mutable TArray<FSlateRenderTransform> MarkerTransforms;
+	mutable float MarkerTransformsRadius = -1.0f;
+	mutable float MarkerTransformsScale = -1.0f;
+
 	/** The radius of the circle */
 	TAttribute<float> Radius;
 
@@ -10,6 +10,10 @@ SHitMarkerConfirmationWidget::SHitMarkerConfirmationWidget()
 {
 }
 
+SHitMarkerConfirmationWidget::~SHitMarkerConfirmationWidget()
+{
+}
+
 void SHitMarkerConfirmationWidget::Construct(const FArguments& InArgs, const FLocalPlayerContext& InContext, const TMap<FGameplayTag, FSlateBrush>& ZoneOverrideImages)
 {
 	PerHitMarkerImage = InArgs._PerHitMarkerImage;
@@ -21,6 +25,35 @@ void SHitMarkerConfirmationWidget::Construct(const FArguments& InArgs, const FLo
 	MyContext = InContext;
 }
 
+bool SHitMarkerConfirmationWidget::ComputeVolatility() const
+{
+	// Tick invalidates whenever the markers change or fade, a bound color can change at any time though
+	return ColorAndOpacity.IsBound();
+}
+
+void SHitMarkerConfirmationWidget::AddHitMarker(const FLyraScreenSpaceHitLocation& Hit)
+{
+	int32 MarkerIndex;
+	if (NumHitMarkers < MaxHitMarkers)
+	{
+		MarkerIndex = (FirstHitMarker + NumHitMarkers) % MaxHitMarkers;
+		++NumHitMarkers;
+	}
+	else
+	{
+		MarkerIndex = FirstHitMarker;
+		FirstHitMarker = (FirstHitMarker + 1) % MaxHitMarkers;
+	}
+
+	FHitMarkerDrawData& Marker = HitMarkers[MarkerIndex];
+	Marker.ScreenLocation = Hit.Location;
+	Marker.Image = PerHitMarkerZoneOverrideImages.Find(Hit.HitZone);
+	if (Marker.Image == nullptr)
+	{
+		Marker.Image = PerHitMarkerImage;
+	}
+}
+
 int32 SHitMarkerConfirmationWidget::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
 {
 	const bool bIsEnabled = ShouldBeEnabled(bParentEnabled);
@@ -31,39 +64,21 @@ int32 SHitMarkerConfirmationWidget::OnPaint(const FPaintArgs& Args, const FGeome
 
 	if (bDrawMarkers)
 	{
-		// Check if we should use screen-space damage location hit notifies
-		TArray<FLyraScreenSpaceHitLocation> LastWeaponDamageScreenLocations;
-		if (APlayerController* PC = MyContext.IsInitialized() ? MyContext.GetPlayerController() : nullptr)
+		for (int32 Offset = 0; Offset < NumHitMarkers; ++Offset)
 		{
-			if (ULyraWeaponStateComponent* WeaponStateComponent = PC->FindComponentByClass<ULyraWeaponStateComponent>())
-			{
-				WeaponStateComponent->GetLastWeaponDamageScreenLocations(/*out*/ LastWeaponDamageScreenLocations);
-			}
-		}
+			const FHitMarkerDrawData& Hit = HitMarkers[(FirstHitMarker + Offset) % MaxHitMarkers];
+			const FSlateBrush* LocationMarkerImage = Hit.Image;
 
-		if ((LastWeaponDamageScreenLocations.Num() > 0) && (PerHitMarkerImage != nullptr))
-		{
-			const FVector2D HalfAbsoluteSize = AllottedGeometry.GetAbsoluteSize() * 0.5f;
+			FLinearColor MarkerColor = bColorAndOpacitySet ?
+				ColorAndOpacity.Get().GetColor(InWidgetStyle) :
+				(InWidgetStyle.GetColorAndOpacityTint() * LocationMarkerImage->GetTint(InWidgetStyle));
+			MarkerColor.A *= HitNotifyOpacity;
 
-			for (const FLyraScreenSpaceHitLocation& Hit : LastWeaponDamageScreenLocations)
-			{
-				const FSlateBrush* LocationMarkerImage = PerHitMarkerZoneOverrideImages.Find(Hit.HitZone);
-				if (LocationMarkerImage == nullptr)
-				{
-					LocationMarkerImage = PerHitMarkerImage;
-				}
-
-				FLinearColor MarkerColor = bColorAndOpacitySet ?
-					ColorAndOpacity.Get().GetColor(InWidgetStyle) :
-					(InWidgetStyle.GetColorAndOpacityTint() * LocationMarkerImage->GetTint(InWidgetStyle));
-				MarkerColor.A *= HitNotifyOpacity;
-
-				const FVector2D WindowSSLocation = Hit.Location + MyCullingRect.GetTopLeft(); // Accounting for window trim when not in fullscreen mode
-				const FSlateRenderTransform DrawPos(AllottedGeometry.AbsoluteToLocal(WindowSSLocation));
-
-				const FPaintGeometry Geometry(AllottedGeometry.ToPaintGeometry(LocationMarkerImage->ImageSize, FSlateLayoutTransform(-(LocationMarkerImage->ImageSize * 0.5f)), DrawPos));
-				FSlateDrawElement::MakeBox(OutDrawElements, LayerId, Geometry, LocationMarkerImage, DrawEffects, MarkerColor);
-			}
+			const FVector2D WindowSSLocation = Hit.ScreenLocation + MyCullingRect.GetTopLeft(); // Accounting for window trim when not in fullscreen mode
+			const FSlateRenderTransform DrawPos(AllottedGeometry.AbsoluteToLocal(WindowSSLocation));
+
+			const FPaintGeometry Geometry(AllottedGeometry.ToPaintGeometry(LocationMarkerImage->ImageSize, FSlateLayoutTransform(-(LocationMarkerImage->ImageSize * 0.5f)), DrawPos));
+			FSlateDrawElement::MakeBox(OutDrawElements, LayerId, Geometry, LocationMarkerImage, DrawEffects, MarkerColor);
 		}
 		
 		if (AnyHitsMarkerImage != nullptr)
@@ -89,17 +104,43 @@ FVector2D SHitMarkerConfirmationWidget::ComputeDesiredSize(float) const
 
 void SHitMarkerConfirmationWidget::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
 {
+	const float PreviousHitNotifyOpacity = HitNotifyOpacity;
 	HitNotifyOpacity = 0.0f;
 
+	ULyraWeaponStateComponent* WeaponStateComponent = nullptr;
 	if (APlayerController* PC = MyContext.IsInitialized() ? MyContext.GetPlayerController() : nullptr)
 	{
-		if (ULyraWeaponStateComponent* DamageMarkerComponent = PC->FindComponentByClass<ULyraWeaponStateComponent>())
+		WeaponStateComponent = PC->FindComponentByClass<ULyraWeaponStateComponent>();
+		if (WeaponStateComponent != nullptr)
 		{
-			const double TimeSinceLastHitNotification = DamageMarkerComponent->GetTimeSinceLastHitNotification();
+			const double TimeSinceLastHitNotification = WeaponStateComponent->GetTimeSinceLastHitNotification();
 			if (TimeSinceLastHitNotification < HitNotifyDuration)
 			{
 				HitNotifyOpacity = FMath::Clamp(1.0f - (float)(TimeSinceLastHitNotification / HitNotifyDuration), 0.0f, 1.0f);
 			}
 		}
 	}
+
+	const bool bDrawMarkers = (HitNotifyOpacity > KINDA_SMALL_NUMBER);
+	const bool bWasDrawingMarkers = (PreviousHitNotifyOpacity > KINDA_SMALL_NUMBER);
+
+	// Nothing to draw before or after, so the last paint is still valid
+	if (!bDrawMarkers && !bWasDrawingMarkers)
+	{
+		return;
+	}
+
+	// While the markers fade they are re-projected too, since they follow the hit locations in the world as the view moves
+	FirstHitMarker = 0;
+	NumHitMarkers = 0;
+	if (bDrawMarkers && (WeaponStateComponent != nullptr) && (PerHitMarkerImage != nullptr))
+	{
+		WeaponStateComponent->GetLastWeaponDamageScreenLocations(/*out*/ ScratchScreenLocations);
+		for (const FLyraScreenSpaceHitLocation& Hit : ScratchScreenLocations)
+		{
+			AddHitMarker(Hit);
+		}
+	}
+
+	Invalidate(EInvalidateWidgetReason::Paint);
 }
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "Containers/StaticArray.h"
 #include "Engine/LocalPlayer.h"
 #include "GameplayTagContainer.h"
 #include "Styling/CoreStyle.h"
@@ -16,6 +17,7 @@ class FSlateWindowElementList;
 class FWidgetStyle;
 struct FGameplayTag;
 struct FGeometry;
+struct FLyraScreenSpaceHitLocation;
 struct FSlateBrush;
 
 class SHitMarkerConfirmationWidget : public SLeafWidget
@@ -40,15 +42,40 @@ public:
 	void Construct(const FArguments& InArgs, const FLocalPlayerContext& InContext, const TMap<FGameplayTag, FSlateBrush>& ZoneOverrideImages);
 
 	SHitMarkerConfirmationWidget();
+	virtual ~SHitMarkerConfirmationWidget();
 
 	//~SWidget interface
 	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
 	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
 	virtual FVector2D ComputeDesiredSize(float) const override;
-	virtual bool ComputeVolatility() const override { return true; }
+	virtual bool ComputeVolatility() const override;
 	//~End of SWidget interface
 
 private:
+	/** A hit marker ready to draw, gathered in Tick so painting doesn't need to look anything up */
+	struct FHitMarkerDrawData
+	{
+		/** Hit location in viewport screenspace */
+		FVector2D ScreenLocation = FVector2D::ZeroVector;
+
+		/** The image for the hit zone */
+		const FSlateBrush* Image = nullptr;
+	};
+
+	/** Maximum number of hit markers drawn at once, the oldest are dropped beyond this */
+	static constexpr int32 MaxHitMarkers = 32;
+
+	/** Adds a marker to the ring buffer, replacing the oldest one when it is full */
+	void AddHitMarker(const FLyraScreenSpaceHitLocation& Hit);
+
+	/** Hit markers to draw, a ring buffer starting at FirstHitMarker */
+	TStaticArray<FHitMarkerDrawData, MaxHitMarkers> HitMarkers;
+	int32 FirstHitMarker = 0;
+	int32 NumHitMarkers = 0;
+
+	/** Reused when reading the hit locations from the weapon state component */
+	TArray<FLyraScreenSpaceHitLocation> ScratchScreenLocations;
+
 	/** The marker image to draw for individual hit markers. */
 	const FSlateBrush* PerHitMarkerImage = nullptr;
 
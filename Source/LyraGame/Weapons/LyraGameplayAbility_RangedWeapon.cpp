@@ -7,7 +7,11 @@
 #include "AIController.h"
 #include "NativeGameplayTags.h"
 #include "Weapons/LyraWeaponStateComponent.h"
+#include "Weapons/LyraWeaponFiringStats.h"
+#include "Weapons/LyraProjectileSubsystem.h"
 #include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "AbilitySystem/LyraGameplayEffectContext.h"
 #include "AbilitySystem/LyraGameplayAbilityTargetData_SingleTargetHit.h"
 #include "DrawDebugHelpers.h"
 
@@ -100,25 +104,34 @@ bool ULyraGameplayAbility_RangedWeapon::CanActivateAbility(const FGameplayAbilit
 	return bResult;
 }
 
+bool ULyraGameplayAbility_RangedWeapon::IsPawnHitResult(const FHitResult& HitResult)
+{
+	if (HitResult.HitObjectHandle.DoesRepresentClass(APawn::StaticClass()))
+	{
+		// If we hit a pawn, we're good
+		return true;
+	}
+	else
+	{
+		AActor* HitActor = HitResult.HitObjectHandle.FetchActor();
+		if ((HitActor != nullptr) && (HitActor->GetAttachParentActor() != nullptr) && (Cast<APawn>(HitActor->GetAttachParentActor()) != nullptr))
+		{
+			// If we hit something attached to a pawn, we're good
+			return true;
+		}
+	}
+
+	return false;
+}
+
 int32 ULyraGameplayAbility_RangedWeapon::FindFirstPawnHitResult(const TArray<FHitResult>& HitResults)
 {
 	for (int32 Idx = 0; Idx < HitResults.Num(); ++Idx)
 	{
-		const FHitResult& CurHitResult = HitResults[Idx];
-		if (CurHitResult.HitObjectHandle.DoesRepresentClass(APawn::StaticClass()))
+		if (IsPawnHitResult(HitResults[Idx]))
 		{
-			// If we hit a pawn, we're good
 			return Idx;
 		}
-		else
-		{
-			AActor* HitActor = CurHitResult.HitObjectHandle.FetchActor();
-			if ((HitActor != nullptr) && (HitActor->GetAttachParentActor() != nullptr) && (Cast<APawn>(HitActor->GetAttachParentActor()) != nullptr))
-			{
-				// If we hit something attached to a pawn, we're good
-				return Idx;
-			}
-		}
 	}
 
 	return INDEX_NONE;
@@ -291,6 +304,8 @@ FTransform ULyraGameplayAbility_RangedWeapon::GetTargetingTransform(APawn* Sourc
 
 FHitResult ULyraGameplayAbility_RangedWeapon::DoSingleBulletTrace(const FVector& StartTrace, const FVector& EndTrace, float SweepRadius, bool bIsSimulated, OUT TArray<FHitResult>& OutHits) const
 {
+	FLyraWeaponFiringStatScope FiringStatScope(ELyraWeaponFiringStage::DoSingleBulletTrace);
+
 #if ENABLE_DRAW_DEBUG
 	if (LyraConsoleVariables::DrawBulletTracesDuration > 0.0f)
 	{
@@ -351,6 +366,8 @@ FHitResult ULyraGameplayAbility_RangedWeapon::DoSingleBulletTrace(const FVector&
 
 void ULyraGameplayAbility_RangedWeapon::PerformLocalTargeting(OUT TArray<FHitResult>& OutHits)
 {
+	FLyraWeaponFiringStatScope FiringStatScope(ELyraWeaponFiringStage::PerformLocalTargeting);
+
 	APawn* const AvatarPawn = Cast<APawn>(GetAvatarActorFromActorInfo());
 
 	ULyraRangedWeaponInstance* WeaponData = GetWeaponInstance();
@@ -399,6 +416,17 @@ void ULyraGameplayAbility_RangedWeapon::TraceBulletsInCartridge(const FRangedWea
 		const FVector EndTrace = InputData.StartTrace + (BulletDir * WeaponData->GetMaxDamageRange());
 		FVector HitLocation = EndTrace;
 
+		if (WeaponData->IsProjectileWeapon())
+		{
+			// Projectiles are simulated after launch, so just record the launch ray (one entry per projectile)
+			FHitResult& LaunchRay = OutHits.AddDefaulted_GetRef();
+			LaunchRay.TraceStart = InputData.StartTrace;
+			LaunchRay.TraceEnd = EndTrace;
+			LaunchRay.Location = EndTrace;
+			LaunchRay.ImpactPoint = EndTrace;
+			continue;
+		}
+
 		TArray<FHitResult> AllImpacts;
 
 		FHitResult Impact = DoSingleBulletTrace(InputData.StartTrace, EndTrace, WeaponData->GetBulletTraceSweepRadius(), /*bIsSimulated=*/ false, /*out*/ AllImpacts);
@@ -476,6 +504,8 @@ void ULyraGameplayAbility_RangedWeapon::EndAbility(const FGameplayAbilitySpecHan
 
 void ULyraGameplayAbility_RangedWeapon::OnTargetDataReadyCallback(const FGameplayAbilityTargetDataHandle& InData, FGameplayTag ApplicationTag)
 {
+	FLyraWeaponFiringStatScope FiringStatScope(ELyraWeaponFiringStage::OnTargetDataReady);
+
 	UAbilitySystemComponent* MyAbilityComponent = CurrentActorInfo->AbilitySystemComponent.Get();
 	check(MyAbilityComponent);
 
@@ -494,7 +524,11 @@ void ULyraGameplayAbility_RangedWeapon::OnTargetDataReadyCallback(const FGamepla
 
 		const bool bIsTargetDataValid = true;
 
-		bool bProjectileWeapon = false;
+		ULyraRangedWeaponInstance* WeaponData = GetWeaponInstance();
+		check(WeaponData);
+
+		// Projectile weapons confirm hit markers once their projectiles have landed (see OnProjectileLaunchResolved)
+		const bool bProjectileWeapon = WeaponData->IsProjectileWeapon();
 
 #if WITH_SERVER_CODE
 		if (!bProjectileWeapon)
@@ -531,12 +565,18 @@ void ULyraGameplayAbility_RangedWeapon::OnTargetDataReadyCallback(const FGamepla
 		if (bIsTargetDataValid && CommitAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo))
 		{
 			// We fired the weapon, add spread
-			ULyraRangedWeaponInstance* WeaponData = GetWeaponInstance();
-			check(WeaponData);
 			WeaponData->AddSpread();
 
-			// Let the blueprint do stuff like apply effects to the targets
-			OnRangedWeaponTargetDataReady(LocalTargetDataHandle);
+			if (bProjectileWeapon)
+			{
+				// The blueprint will be told about the targets as the projectiles hit them
+				LaunchProjectiles(LocalTargetDataHandle, WeaponData);
+			}
+			else
+			{
+				// Let the blueprint do stuff like apply effects to the targets
+				OnRangedWeaponTargetDataReady(LocalTargetDataHandle);
+			}
 		}
 		else
 		{
@@ -549,6 +589,133 @@ void ULyraGameplayAbility_RangedWeapon::OnTargetDataReadyCallback(const FGamepla
 	MyAbilityComponent->ConsumeClientReplicatedTargetData(CurrentSpecHandle, CurrentActivationInfo.GetActivationPredictionKey());
 }
 
+void ULyraGameplayAbility_RangedWeapon::LaunchProjectiles(const FGameplayAbilityTargetDataHandle& TargetData, ULyraRangedWeaponInstance* WeaponData)
+{
+	ULyraProjectileSubsystem* ProjectileSubsystem = ULyraProjectileSubsystem::Get(this);
+	if ((ProjectileSubsystem == nullptr) || (TargetData.Num() == 0))
+	{
+		return;
+	}
+
+	// Projectile hits don't go through OnRangedWeaponTargetDataReady, so without either of these they'd do nothing
+	ensureMsgf((ProjectileImpactEffect != nullptr) || GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(ThisClass, OnProjectileImpactTargetDataReady)),
+		TEXT("%s fires projectiles (%s) but has no ProjectileImpactEffect and doesn't implement OnProjectileImpactTargetDataReady, its hits won't deal damage"),
+		*GetPathNameSafe(GetClass()), *GetPathNameSafe(WeaponData));
+
+	FVector StartLocation = FVector::ZeroVector;
+	int32 CartridgeID = -1;
+	TArray<FVector, TInlineAllocator<16>> Directions;
+	for (int32 Index = 0; Index < TargetData.Num(); ++Index)
+	{
+		if (const FGameplayAbilityTargetData* Data = TargetData.Get(Index))
+		{
+			if (const FHitResult* LaunchRay = Data->GetHitResult())
+			{
+				StartLocation = LaunchRay->TraceStart;
+				Directions.Add(LaunchRay->TraceEnd - LaunchRay->TraceStart);
+			}
+
+			if (Data->GetScriptStruct() == FLyraGameplayAbilityTargetData_SingleTargetHit::StaticStruct())
+			{
+				CartridgeID = static_cast<const FLyraGameplayAbilityTargetData_SingleTargetHit*>(Data)->CartridgeID;
+			}
+		}
+	}
+
+	FLyraProjectileLaunchParams Params;
+	Params.Instigator = GetAvatarActorFromActorInfo();
+	Params.Speed = WeaponData->GetProjectileSpeed();
+	Params.GravityScale = WeaponData->GetProjectileGravityScale();
+	Params.Radius = WeaponData->GetBulletTraceSweepRadius();
+	Params.MaxLifetime = WeaponData->GetProjectileMaxLifetime();
+	Params.UniqueId = TargetData.UniqueId;
+	Params.OnImpact = FOnLyraProjectileImpact::CreateUObject(this, &ThisClass::OnProjectileImpact, CartridgeID);
+	Params.OnResolved = FOnLyraProjectileLaunchResolved::CreateUObject(this, &ThisClass::OnProjectileLaunchResolved);
+
+	ProjectileSubsystem->LaunchProjectiles(Params, StartLocation, Directions);
+}
+
+void ULyraGameplayAbility_RangedWeapon::OnProjectileImpact(uint8 UniqueId, int32 ProjectileIndex, const FHitResult& Impact, int32 CartridgeID)
+{
+	if (CurrentActorInfo == nullptr)
+	{
+		return;
+	}
+
+	// Fill in the hit marker that was reserved for this projectile when it was fired
+	if (CurrentActorInfo->IsLocallyControlled())
+	{
+		if (AController* Controller = GetControllerFromActorInfo())
+		{
+			if (ULyraWeaponStateComponent* WeaponStateComponent = Controller->FindComponentByClass<ULyraWeaponStateComponent>())
+			{
+				WeaponStateComponent->UpdateUnconfirmedServerSideHitMarker(UniqueId, ProjectileIndex, Impact);
+			}
+		}
+	}
+
+#if WITH_SERVER_CODE
+	// By the time a projectile lands the shot's activation (and its prediction key) is usually gone,
+	// so the server applies the impact effect itself with a fresh context instead of going through target data
+	if (CurrentActorInfo->IsNetAuthority() && Impact.bBlockingHit && (ProjectileImpactEffect != nullptr))
+	{
+		UAbilitySystemComponent* SourceASC = CurrentActorInfo->AbilitySystemComponent.Get();
+		UAbilitySystemComponent* TargetASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Impact.GetActor());
+		if ((SourceASC != nullptr) && (TargetASC != nullptr))
+		{
+			FGameplayEffectContextHandle EffectContext = MakeEffectContext(CurrentSpecHandle, CurrentActorInfo);
+			EffectContext.AddHitResult(Impact, /*bReset=*/ true);
+			if (FLyraGameplayEffectContext* LyraEffectContext = FLyraGameplayEffectContext::ExtractEffectContext(EffectContext))
+			{
+				LyraEffectContext->CartridgeID = CartridgeID;
+			}
+
+			const FGameplayEffectSpecHandle SpecHandle = SourceASC->MakeOutgoingSpec(ProjectileImpactEffect, GetAbilityLevel(), EffectContext);
+			if (SpecHandle.IsValid())
+			{
+				SourceASC->ApplyGameplayEffectSpecToTarget(*SpecHandle.Data.Get(), TargetASC);
+			}
+		}
+	}
+#endif
+
+	// Hand the impact to the blueprint in the same shape as hitscan target data (e.g., for impact cues or custom effects).
+	// There is no prediction window by now, so anything gameplay affecting must only be done with authority.
+	FGameplayAbilityTargetDataHandle TargetData;
+	TargetData.UniqueId = UniqueId;
+
+	FLyraGameplayAbilityTargetData_SingleTargetHit* NewTargetData = new FLyraGameplayAbilityTargetData_SingleTargetHit();
+	NewTargetData->HitResult = Impact;
+	NewTargetData->CartridgeID = CartridgeID;
+	TargetData.Add(NewTargetData);
+
+	OnProjectileImpactTargetDataReady(TargetData);
+}
+
+void ULyraGameplayAbility_RangedWeapon::OnProjectileLaunchResolved(uint8 UniqueId, TConstArrayView<FHitResult> Impacts)
+{
+#if WITH_SERVER_CODE
+	AController* Controller = (CurrentActorInfo != nullptr) ? GetControllerFromActorInfo() : nullptr;
+	if ((Controller != nullptr) && (Controller->GetLocalRole() == ROLE_Authority))
+	{
+		if (ULyraWeaponStateComponent* WeaponStateComponent = Controller->FindComponentByClass<ULyraWeaponStateComponent>())
+		{
+			// Any projectile that didn't hit a pawn on the server replaces whatever the client predicted for it
+			TArray<uint8> HitReplaces;
+			for (int32 Index = 0; (Index < Impacts.Num()) && (Index < 255); ++Index)
+			{
+				if (!IsPawnHitResult(Impacts[Index]))
+				{
+					HitReplaces.Add((uint8)Index);
+				}
+			}
+
+			WeaponStateComponent->ClientConfirmTargetData(UniqueId, /*bSuccess=*/ true, HitReplaces);
+		}
+	}
+#endif
+}
+
 void ULyraGameplayAbility_RangedWeapon::StartRangedWeaponTargeting()
 {
 	check(CurrentActorInfo);
@@ -568,9 +735,14 @@ void ULyraGameplayAbility_RangedWeapon::StartRangedWeaponTargeting()
 	TArray<FHitResult> FoundHits;
 	PerformLocalTargeting(/*out*/ FoundHits);
 
+	if (const ULyraRangedWeaponInstance* WeaponData = GetWeaponInstance())
+	{
+		FLyraWeaponFiringStats::Get().AddShot(WeaponData->GetBulletsPerCartridge());
+	}
+
 	// Fill out the target data from the hit results
 	FGameplayAbilityTargetDataHandle TargetData;
-	TargetData.UniqueId = WeaponStateComponent ? WeaponStateComponent->GetUnconfirmedServerSideHitMarkerCount() : 0;
+	TargetData.UniqueId = WeaponStateComponent ? WeaponStateComponent->GetNextHitMarkerBatchId() : 0;
 
 	if (FoundHits.Num() > 0)
 	{
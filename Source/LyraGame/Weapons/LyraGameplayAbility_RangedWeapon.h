@@ -10,6 +10,7 @@ enum ECollisionChannel : int;
 
 class APawn;
 class ULyraRangedWeaponInstance;
+class UGameplayEffect;
 class UObject;
 struct FCollisionQueryParams;
 struct FFrame;
@@ -88,6 +89,7 @@ protected:
 	};
 
 protected:
+	static bool IsPawnHitResult(const FHitResult& HitResult);
 	static int32 FindFirstPawnHitResult(const TArray<FHitResult>& HitResults);
 
 	// Does a single weapon trace, either sweeping or ray depending on if SweepRadius is above zero
@@ -111,6 +113,15 @@ protected:
 
 	void OnTargetDataReadyCallback(const FGameplayAbilityTargetDataHandle& InData, FGameplayTag ApplicationTag);
 
+	// Launches one projectile per entry in the target data (whose traces hold the launch directions) through ULyraProjectileSubsystem
+	void LaunchProjectiles(const FGameplayAbilityTargetDataHandle& TargetData, ULyraRangedWeaponInstance* WeaponData);
+
+	// Called when one of our projectiles hits something; updates the local hit marker, applies ProjectileImpactEffect to the target on the server, and calls OnProjectileImpactTargetDataReady
+	void OnProjectileImpact(uint8 UniqueId, int32 ProjectileIndex, const FHitResult& Impact, int32 CartridgeID);
+
+	// Called when all projectiles from a single shot have hit or expired; confirms hit markers with the owning client
+	void OnProjectileLaunchResolved(uint8 UniqueId, TConstArrayView<FHitResult> Impacts);
+
 	UFUNCTION(BlueprintCallable)
 	void StartRangedWeaponTargeting();
 
@@ -118,6 +129,16 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent)
 	void OnRangedWeaponTargetDataReady(const FGameplayAbilityTargetDataHandle& TargetData);
 
+	// Called when one of our projectiles hits something (on the owning client and the server), with the same target data as hitscan hits.
+	// The firing activation has usually ended by then, so effects should only be applied with authority (or use ProjectileImpactEffect).
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnProjectileImpactTargetDataReady(const FGameplayAbilityTargetDataHandle& TargetData);
+
+protected:
+	// Effect the server applies to whatever a projectile hits (projectile impacts don't go through OnRangedWeaponTargetDataReady, since the shot's ability activation has usually ended by then)
+	UPROPERTY(EditDefaultsOnly, Category="Lyra|Projectile")
+	TSubclassOf<UGameplayEffect> ProjectileImpactEffect;
+
 private:
 	FDelegateHandle OnTargetDataReadyCallbackDelegateHandle;
 };
@@ -0,0 +1,240 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Weapons/LyraProjectileSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Physics/LyraCollisionChannels.h"
+#include "DrawDebugHelpers.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(LyraProjectileSubsystem)
+
+namespace LyraProjectileCVars
+{
+	// Changing this while projectiles are in flight (or to different values on client and server) breaks prediction
+	static float SimulationRate = 60.0f;
+	static FAutoConsoleVariableRef CVarSimulationRate(
+		TEXT("Lyra.Projectile.SimulationRate"),
+		SimulationRate,
+		TEXT("Fixed rate (in Hz) at which weapon projectiles are stepped and swept. Must match between client and server."),
+		ECVF_Default);
+
+	static int32 MaxStepsPerFrame = 4;
+	static FAutoConsoleVariableRef CVarMaxStepsPerFrame(
+		TEXT("Lyra.Projectile.MaxStepsPerFrame"),
+		MaxStepsPerFrame,
+		TEXT("Maximum number of simulation steps per frame (any remaining time is dropped to avoid a spiral of death)"),
+		ECVF_Default);
+
+	static float DrawProjectileDuration = 0.0f;
+	static FAutoConsoleVariableRef CVarDrawProjectileDuration(
+		TEXT("Lyra.Projectile.DrawDuration"),
+		DrawProjectileDuration,
+		TEXT("Should we do debug drawing for projectile sweeps (if above zero, sets how long (in seconds))"),
+		ECVF_Default);
+}
+
+ULyraProjectileSubsystem* ULyraProjectileSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = (WorldContextObject != nullptr) ? WorldContextObject->GetWorld() : nullptr;
+	return (World != nullptr) ? World->GetSubsystem<ULyraProjectileSubsystem>() : nullptr;
+}
+
+TStatId ULyraProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULyraProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void ULyraProjectileSubsystem::Deinitialize()
+{
+	// Resolve anything still in flight so listeners aren't left waiting on it; impacts that never
+	// landed are still default (no blocking hit) and read as misses. When the world is tearing down
+	// the listeners (and the controllers they'd send confirmations to) are going away too, so just drop them.
+	TArray<FLyraProjectileLaunchParams> UnresolvedParams;
+	TArray<TArray<FHitResult>> UnresolvedImpacts;
+	const UWorld* World = GetWorld();
+	if ((World != nullptr) && !World->bIsTearingDown)
+	{
+		for (FLaunchState& Launch : Launches)
+		{
+			UnresolvedParams.Add(MoveTemp(Launch.Params));
+			UnresolvedImpacts.Add(MoveTemp(Launch.Impacts));
+		}
+	}
+
+	Projectiles.Empty();
+	Launches.Empty();
+	PendingResults.Empty();
+
+	for (int32 Index = 0; Index < UnresolvedParams.Num(); ++Index)
+	{
+		UnresolvedParams[Index].OnResolved.ExecuteIfBound(UnresolvedParams[Index].UniqueId, UnresolvedImpacts[Index]);
+	}
+
+	Super::Deinitialize();
+}
+
+void ULyraProjectileSubsystem::LaunchProjectiles(const FLyraProjectileLaunchParams& Params, const FVector& StartLocation, TConstArrayView<FVector> Directions)
+{
+	if (Directions.Num() == 0)
+	{
+		return;
+	}
+
+	const float StepTime = 1.0f / FMath::Max(LyraProjectileCVars::SimulationRate, 1.0f);
+	const float GravityZ = GetWorld()->GetGravityZ() * Params.GravityScale;
+
+	const int32 LaunchIndex = Launches.Add(FLaunchState());
+	FLaunchState& Launch = Launches[LaunchIndex];
+	Launch.Params = Params;
+	Launch.Impacts.SetNum(Directions.Num());
+	Launch.NumOutstanding = Directions.Num();
+
+	Projectiles.Reserve(Projectiles.Num() + Directions.Num());
+	for (int32 ProjectileIndex = 0; ProjectileIndex < Directions.Num(); ++ProjectileIndex)
+	{
+		FProjectileState& Projectile = Projectiles.AddDefaulted_GetRef();
+		Projectile.StartLocation = StartLocation;
+		Projectile.StartVelocity = Directions[ProjectileIndex].GetSafeNormal() * Params.Speed;
+		Projectile.Location = StartLocation;
+		Projectile.HalfGravityZ = 0.5f * GravityZ;
+		Projectile.Radius = Params.Radius;
+		Projectile.MaxSteps = FMath::Max(1, FMath::CeilToInt32(Params.MaxLifetime / StepTime));
+		Projectile.LaunchIndex = LaunchIndex;
+		Projectile.ProjectileIndex = ProjectileIndex;
+
+		// Expired projectiles resolve with no blocking hit at their last location
+		FHitResult& Impact = Launch.Impacts[ProjectileIndex];
+		Impact.TraceStart = StartLocation;
+		Impact.TraceEnd = StartLocation + Projectile.StartVelocity;
+	}
+}
+
+void ULyraProjectileSubsystem::Tick(float DeltaTime)
+{
+	if (Projectiles.Num() == 0)
+	{
+		TimeAccumulator = 0.0;
+		return;
+	}
+
+	const double StepTime = 1.0 / FMath::Max(LyraProjectileCVars::SimulationRate, 1.0f);
+
+	TimeAccumulator += DeltaTime;
+
+	int32 NumSteps = 0;
+	while ((TimeAccumulator >= StepTime) && (Projectiles.Num() > 0))
+	{
+		TimeAccumulator -= StepTime;
+		StepProjectiles();
+
+		if (++NumSteps >= LyraProjectileCVars::MaxStepsPerFrame)
+		{
+			TimeAccumulator = 0.0;
+			break;
+		}
+	}
+}
+
+void ULyraProjectileSubsystem::StepProjectiles()
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_LyraProjectileSubsystem_StepProjectiles);
+
+	UWorld* World = GetWorld();
+	const float StepTime = 1.0f / FMath::Max(LyraProjectileCVars::SimulationRate, 1.0f);
+
+	PendingResults.Reset();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(LyraProjectileSweep), /*bTraceComplex=*/ true);
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	// Sweep every projectile along its next segment in one pass over the packed state
+	for (int32 ArrayIndex = 0; ArrayIndex < Projectiles.Num(); ++ArrayIndex)
+	{
+		FProjectileState& Projectile = Projectiles[ArrayIndex];
+
+		++Projectile.NumStepsTaken;
+		const float TimeSinceLaunch = Projectile.NumStepsTaken * StepTime;
+		const FVector NewLocation = Projectile.StartLocation + (Projectile.StartVelocity * TimeSinceLaunch) + FVector(0.0f, 0.0f, Projectile.HalfGravityZ * TimeSinceLaunch * TimeSinceLaunch);
+
+		QueryParams.ClearIgnoredSourceObjects();
+		if (AActor* Instigator = Launches[Projectile.LaunchIndex].Params.Instigator.Get())
+		{
+			QueryParams.AddIgnoredActor(Instigator);
+		}
+
+		FHitResult Hit;
+		const bool bHit = (Projectile.Radius > 0.0f) ?
+			World->SweepSingleByChannel(Hit, Projectile.Location, NewLocation, FQuat::Identity, Lyra_TraceChannel_Weapon, FCollisionShape::MakeSphere(Projectile.Radius), QueryParams) :
+			World->LineTraceSingleByChannel(Hit, Projectile.Location, NewLocation, Lyra_TraceChannel_Weapon, QueryParams);
+
+#if ENABLE_DRAW_DEBUG
+		if (LyraProjectileCVars::DrawProjectileDuration > 0.0f)
+		{
+			DrawDebugLine(World, Projectile.Location, bHit ? Hit.Location : NewLocation, bHit ? FColor::Red : FColor::Orange, false, LyraProjectileCVars::DrawProjectileDuration);
+		}
+#endif
+
+		Projectile.Location = bHit ? Hit.Location : NewLocation;
+
+		if (bHit || (Projectile.NumStepsTaken >= Projectile.MaxSteps))
+		{
+			FPendingResult& Result = PendingResults.AddDefaulted_GetRef();
+			Result.ProjectileArrayIndex = ArrayIndex;
+			Result.bHit = bHit;
+			if (bHit)
+			{
+				Result.Impact = MoveTemp(Hit);
+			}
+		}
+	}
+
+	// Remove the finished projectiles before running any callbacks (which may launch new ones),
+	// going backwards so the swap-removes don't disturb indices we have yet to visit
+	TArray<FProjectileState, TInlineAllocator<16>> FinishedProjectiles;
+	for (int32 ResultIndex = PendingResults.Num() - 1; ResultIndex >= 0; --ResultIndex)
+	{
+		FinishedProjectiles.Add(Projectiles[PendingResults[ResultIndex].ProjectileArrayIndex]);
+		Projectiles.RemoveAtSwap(PendingResults[ResultIndex].ProjectileArrayIndex, EAllowShrinking::No);
+	}
+
+	// Dispatch in the original order
+	for (int32 ResultIndex = 0; ResultIndex < PendingResults.Num(); ++ResultIndex)
+	{
+		const FPendingResult& Result = PendingResults[ResultIndex];
+		ResolveProjectile(FinishedProjectiles[PendingResults.Num() - 1 - ResultIndex], Result.Impact, Result.bHit);
+	}
+}
+
+void ULyraProjectileSubsystem::ResolveProjectile(const FProjectileState& Projectile, const FHitResult& Impact, bool bHit)
+{
+	if (!Launches.IsValidIndex(Projectile.LaunchIndex))
+	{
+		return;
+	}
+
+	FLaunchState& Launch = Launches[Projectile.LaunchIndex];
+
+	if (bHit)
+	{
+		Launch.Impacts[Projectile.ProjectileIndex] = Impact;
+		Launch.Params.OnImpact.ExecuteIfBound(Launch.Params.UniqueId, Projectile.ProjectileIndex, Impact);
+	}
+	else
+	{
+		FHitResult& Expired = Launch.Impacts[Projectile.ProjectileIndex];
+		Expired.Location = Projectile.Location;
+		Expired.ImpactPoint = Projectile.Location;
+	}
+
+	// The callback above may have launched more projectiles, so look the launch up again
+	FLaunchState& LaunchAfterImpact = Launches[Projectile.LaunchIndex];
+	if (--LaunchAfterImpact.NumOutstanding <= 0)
+	{
+		const FLyraProjectileLaunchParams Params = MoveTemp(LaunchAfterImpact.Params);
+		const TArray<FHitResult> Impacts = MoveTemp(LaunchAfterImpact.Impacts);
+		Launches.RemoveAt(Projectile.LaunchIndex);
+
+		Params.OnResolved.ExecuteIfBound(Params.UniqueId, Impacts);
+	}
+}
@@ -0,0 +1,118 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/SparseArray.h"
+#include "Engine/HitResult.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "LyraProjectileSubsystem.generated.h"
+
+class AActor;
+class UObject;
+
+// Called when a projectile hits something (UniqueId of the launch, index of the projectile within the launch, the impact)
+DECLARE_DELEGATE_ThreeParams(FOnLyraProjectileImpact, uint8 /*UniqueId*/, int32 /*ProjectileIndex*/, const FHitResult& /*Impact*/);
+
+// Called once every projectile in a launch has either hit something or expired (Impacts has one entry per projectile, with no blocking hit for expired ones)
+DECLARE_DELEGATE_TwoParams(FOnLyraProjectileLaunchResolved, uint8 /*UniqueId*/, TConstArrayView<FHitResult> /*Impacts*/);
+
+/** Describes a group of projectiles fired together (e.g., all of the pellets in a cartridge) */
+struct FLyraProjectileLaunchParams
+{
+	// Actor that fired the projectiles (ignored by the projectile sweeps)
+	TWeakObjectPtr<AActor> Instigator;
+
+	// Initial speed of the projectiles (in cm/s)
+	float Speed = 0.0f;
+
+	// Multiplier on world gravity
+	float GravityScale = 0.0f;
+
+	// Radius of the projectile sweeps (0.0 will result in line traces)
+	float Radius = 0.0f;
+
+	// Maximum lifetime before the projectile expires (in seconds)
+	float MaxLifetime = 5.0f;
+
+	// Target data unique ID of the shot that launched these projectiles
+	uint8 UniqueId = 0;
+
+	FOnLyraProjectileImpact OnImpact;
+	FOnLyraProjectileLaunchResolved OnResolved;
+};
+
+/**
+ * ULyraProjectileSubsystem
+ *
+ * Simulates weapon projectiles without spawning an actor per shot.
+ *
+ * Projectile state is kept in a single contiguous array and every projectile is swept once per fixed simulation
+ * step. Trajectories are evaluated analytically at whole multiples of the step since launch, so a locally predicted
+ * projectile and the authoritative one on the server sweep exactly the same segments, regardless of frame rate.
+ */
+UCLASS()
+class ULyraProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static ULyraProjectileSubsystem* Get(const UObject* WorldContextObject);
+
+	//~FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~End of FTickableGameObject interface
+
+	//~USubsystem interface
+	virtual void Deinitialize() override;
+	//~End of USubsystem interface
+
+	// Launches one projectile per entry in Directions (all starting from StartLocation)
+	void LaunchProjectiles(const FLyraProjectileLaunchParams& Params, const FVector& StartLocation, TConstArrayView<FVector> Directions);
+
+	int32 GetNumActiveProjectiles() const { return Projectiles.Num(); }
+
+private:
+	struct FProjectileState
+	{
+		FVector StartLocation;
+		FVector StartVelocity;
+		FVector Location;
+		float HalfGravityZ = 0.0f;
+		float Radius = 0.0f;
+		int32 NumStepsTaken = 0;
+		int32 MaxSteps = 0;
+		int32 LaunchIndex = INDEX_NONE;
+		int32 ProjectileIndex = 0;
+	};
+
+	struct FLaunchState
+	{
+		FLyraProjectileLaunchParams Params;
+		TArray<FHitResult> Impacts;
+		int32 NumOutstanding = 0;
+	};
+
+	struct FPendingResult
+	{
+		int32 ProjectileArrayIndex = INDEX_NONE;
+		FHitResult Impact;
+		bool bHit = false;
+	};
+
+	void StepProjectiles();
+	void ResolveProjectile(const FProjectileState& Projectile, const FHitResult& Impact, bool bHit);
+
+private:
+	// All live projectiles, packed (removed with swap-remove)
+	TArray<FProjectileState> Projectiles;
+
+	// Launch groups that still have projectiles in flight
+	TSparseArray<FLaunchState> Launches;
+
+	// Scratch list of projectiles that hit something or expired this step
+	TArray<FPendingResult> PendingResults;
+
+	double TimeAccumulator = 0.0;
+};
@@ -7,11 +7,68 @@
 #include "Camera/LyraCameraComponent.h"
 #include "Physics/PhysicalMaterialWithTags.h"
 #include "Weapons/LyraWeaponInstance.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraRangedWeaponInstance)
 
 UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Lyra_Weapon_SteadyAimingCamera, "Lyra.Weapon.SteadyAimingCamera");
 
+namespace LyraRangedWeaponCVars
+{
+	static bool bUseExactCurves = false;
+	static FAutoConsoleVariableRef CVarUseExactCurves(
+		TEXT("Lyra.Weapon.UseExactCurves"),
+		bUseExactCurves,
+		TEXT("Should ranged weapons evaluate their heat/spread/falloff curves directly instead of using the baked lookup tables (for validation)"),
+		ECVF_Default);
+
+#if !UE_BUILD_SHIPPING
+	static FAutoConsoleCommand CmdBenchmarkBakedCurves(
+		TEXT("Lyra.Weapon.BenchmarkBakedCurves"),
+		TEXT("Usage: Lyra.Weapon.BenchmarkBakedCurves [NumEvaluations]\nTimes the baked weapon curve lookup tables against the source curves for every loaded ranged weapon class."),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+		{
+			const int32 NumEvaluations = (Args.Num() > 0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+
+			for (TObjectIterator<UClass> ClassIt; ClassIt; ++ClassIt)
+			{
+				UClass* WeaponClass = *ClassIt;
+				if (WeaponClass->IsChildOf(ULyraRangedWeaponInstance::StaticClass()) &&
+					!WeaponClass->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists) &&
+					!WeaponClass->GetName().StartsWith(TEXT("SKEL_")) &&
+					!WeaponClass->GetName().StartsWith(TEXT("REINST_")))
+				{
+					WeaponClass->GetDefaultObject<ULyraRangedWeaponInstance>()->BenchmarkBakedCurves(NumEvaluations, Ar);
+				}
+			}
+		}));
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////
+// FLyraBakedCurveLUT
+
+void FLyraBakedCurveLUT::Bake(const FRichCurve& Curve, float InMinTime, float InMaxTime)
+{
+	MinTime = InMinTime;
+	MaxTime = FMath::Max(InMinTime, InMaxTime);
+
+	const float Range = MaxTime - MinTime;
+	const float SampleStep = Range / float(NumSamples - 1);
+	InvSampleStep = (Range > UE_SMALL_NUMBER) ? (1.0f / SampleStep) : 0.0f;
+
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		Samples[Index] = Curve.Eval(MinTime + (SampleStep * float(Index)));
+	}
+
+	bValid = true;
+}
+
+//////////////////////////////////////////////////////////////////////
+// ULyraRangedWeaponInstance
+
 ULyraRangedWeaponInstance::ULyraRangedWeaponInstance(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -23,6 +80,12 @@ void ULyraRangedWeaponInstance::PostLoad()
 {
 	Super::PostLoad();
 
+	// Bake the curves up front for weapon classes, so the first shot doesn't pay for it
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		BakedCurves = BuildBakedCurves();
+	}
+
 #if WITH_EDITOR
 	UpdateDebugVisualization();
 #endif
@@ -32,6 +95,11 @@ void ULyraRangedWeaponInstance::PostLoad()
 void ULyraRangedWeaponInstance::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Rebake on next use; instances created afterwards will pick up the new tables
+	BakedCurves.Reset();
+	PhysicalMaterialMultipliers.Reset();
+
 	UpdateDebugVisualization();
 }
 
@@ -50,13 +118,11 @@ void ULyraRangedWeaponInstance::OnEquipped()
 	Super::OnEquipped();
 
 	// Start heat in the middle
-	float MinHeatRange;
-	float MaxHeatRange;
-	ComputeHeatRange(/*out*/ MinHeatRange, /*out*/ MaxHeatRange);
-	CurrentHeat = (MinHeatRange + MaxHeatRange) * 0.5f;
+	const FLyraRangedWeaponBakedCurves& Baked = GetBakedCurves();
+	CurrentHeat = (Baked.MinHeat + Baked.MaxHeat) * 0.5f;
 
 	// Derive spread
-	CurrentSpreadAngle = HeatToSpreadCurve.GetRichCurveConst()->Eval(CurrentHeat);
+	CurrentSpreadAngle = EvalBakedCurve(Baked.HeatToSpread, HeatToSpreadCurve, CurrentHeat);
 
 	// Default the multipliers to 1x
 	CurrentSpreadAngleMultiplier = 1.0f;
@@ -85,7 +151,61 @@ void ULyraRangedWeaponInstance::Tick(float DeltaSeconds)
 #endif
 }
 
-void ULyraRangedWeaponInstance::ComputeHeatRange(float& MinHeat, float& MaxHeat)
+const FLyraRangedWeaponBakedCurves& ULyraRangedWeaponInstance::GetBakedCurves() const
+{
+	if (!BakedCurves.IsValid())
+	{
+		const ULyraRangedWeaponInstance* WeaponCDO = GetClass()->GetDefaultObject<ULyraRangedWeaponInstance>();
+		if (WeaponCDO != this)
+		{
+			WeaponCDO->GetBakedCurves();
+			BakedCurves = WeaponCDO->BakedCurves;
+		}
+		else
+		{
+			BakedCurves = BuildBakedCurves();
+		}
+	}
+
+	return *BakedCurves;
+}
+
+TSharedPtr<const FLyraRangedWeaponBakedCurves> ULyraRangedWeaponInstance::BuildBakedCurves() const
+{
+	TSharedPtr<FLyraRangedWeaponBakedCurves> Result = MakeShared<FLyraRangedWeaponBakedCurves>();
+
+	ComputeHeatRange(/*out*/ Result->MinHeat, /*out*/ Result->MaxHeat);
+	ComputeSpreadRange(/*out*/ Result->MinSpread, /*out*/ Result->MaxSpread);
+
+	// Heat is always clamped to the combined heat range, so the heat curves are baked over all of it
+	Result->HeatToHeatPerShot.Bake(*HeatToHeatPerShotCurve.GetRichCurveConst(), Result->MinHeat, Result->MaxHeat);
+	Result->HeatToCoolDownPerSecond.Bake(*HeatToCoolDownPerSecondCurve.GetRichCurveConst(), Result->MinHeat, Result->MaxHeat);
+	Result->HeatToSpread.Bake(*HeatToSpreadCurve.GetRichCurveConst(), Result->MinHeat, Result->MaxHeat);
+
+	// Hits can't be further away than the max damage range, but the curve may have keys past it
+	const FRichCurve* FalloffCurve = DistanceDamageFalloff.GetRichCurveConst();
+	if (FalloffCurve->HasAnyData())
+	{
+		float MinDistance;
+		float MaxDistance;
+		FalloffCurve->GetTimeRange(/*out*/ MinDistance, /*out*/ MaxDistance);
+		Result->DistanceDamageFalloff.Bake(*FalloffCurve, FMath::Min(MinDistance, 0.0f), FMath::Max(MaxDistance, MaxDamageRange));
+	}
+
+	return Result;
+}
+
+float ULyraRangedWeaponInstance::EvalBakedCurve(const FLyraBakedCurveLUT& LUT, const FRuntimeFloatCurve& Curve, float Time)
+{
+	if (LUT.Covers(Time) && !LyraRangedWeaponCVars::bUseExactCurves)
+	{
+		return LUT.Eval(Time);
+	}
+
+	return Curve.GetRichCurveConst()->Eval(Time);
+}
+
+void ULyraRangedWeaponInstance::ComputeHeatRange(float& MinHeat, float& MaxHeat) const
 {
 	float Min1;
 	float Max1;
@@ -103,19 +223,21 @@ void ULyraRangedWeaponInstance::ComputeHeatRange(float& MinHeat, float& MaxHeat)
 	MaxHeat = FMath::Max(FMath::Max(Max1, Max2), Max3);
 }
 
-void ULyraRangedWeaponInstance::ComputeSpreadRange(float& MinSpread, float& MaxSpread)
+void ULyraRangedWeaponInstance::ComputeSpreadRange(float& MinSpread, float& MaxSpread) const
 {
 	HeatToSpreadCurve.GetRichCurveConst()->GetValueRange(/*out*/ MinSpread, /*out*/ MaxSpread);
 }
 
 void ULyraRangedWeaponInstance::AddSpread()
 {
+	const FLyraRangedWeaponBakedCurves& Baked = GetBakedCurves();
+
 	// Sample the heat up curve
-	const float HeatPerShot = HeatToHeatPerShotCurve.GetRichCurveConst()->Eval(CurrentHeat);
+	const float HeatPerShot = EvalBakedCurve(Baked.HeatToHeatPerShot, HeatToHeatPerShotCurve, CurrentHeat);
 	CurrentHeat = ClampHeat(CurrentHeat + HeatPerShot);
 
 	// Map the heat to the spread angle
-	CurrentSpreadAngle = HeatToSpreadCurve.GetRichCurveConst()->Eval(CurrentHeat);
+	CurrentSpreadAngle = EvalBakedCurve(Baked.HeatToSpread, HeatToSpreadCurve, CurrentHeat);
 
 #if WITH_EDITOR
 	UpdateDebugVisualization();
@@ -124,11 +246,31 @@ void ULyraRangedWeaponInstance::AddSpread()
 
 float ULyraRangedWeaponInstance::GetDistanceAttenuation(float Distance, const FGameplayTagContainer* SourceTags, const FGameplayTagContainer* TargetTags) const
 {
-	const FRichCurve* Curve = DistanceDamageFalloff.GetRichCurveConst();
-	return Curve->HasAnyData() ? Curve->Eval(Distance) : 1.0f;
+	const FLyraBakedCurveLUT& FalloffLUT = GetBakedCurves().DistanceDamageFalloff;
+	return FalloffLUT.IsValid() ? EvalBakedCurve(FalloffLUT, DistanceDamageFalloff, Distance) : 1.0f;
 }
 
 float ULyraRangedWeaponInstance::GetPhysicalMaterialAttenuation(const UPhysicalMaterial* PhysicalMaterial, const FGameplayTagContainer* SourceTags, const FGameplayTagContainer* TargetTags) const
+{
+	const uint32 TagsGeneration = UPhysicalMaterialWithTags::GetTagsGeneration();
+	if (PhysicalMaterialTagsGeneration != TagsGeneration)
+	{
+		PhysicalMaterialMultipliers.Reset();
+		PhysicalMaterialTagsGeneration = TagsGeneration;
+	}
+
+	const TObjectKey<UPhysicalMaterial> MaterialKey(PhysicalMaterial);
+	if (const float* CachedMultiplier = PhysicalMaterialMultipliers.Find(MaterialKey))
+	{
+		return *CachedMultiplier;
+	}
+
+	const float CombinedMultiplier = ComputePhysicalMaterialAttenuation(PhysicalMaterial);
+	PhysicalMaterialMultipliers.Add(MaterialKey, CombinedMultiplier);
+	return CombinedMultiplier;
+}
+
+float ULyraRangedWeaponInstance::ComputePhysicalMaterialAttenuation(const UPhysicalMaterial* PhysicalMaterial) const
 {
 	float CombinedMultiplier = 1.0f;
 	if (const UPhysicalMaterialWithTags* PhysMatWithTags = Cast<const UPhysicalMaterialWithTags>(PhysicalMaterial))
@@ -149,18 +291,16 @@ bool ULyraRangedWeaponInstance::UpdateSpread(float DeltaSeconds)
 {
 	const float TimeSinceFired = GetWorld()->TimeSince(LastFireTime);
 
+	const FLyraRangedWeaponBakedCurves& Baked = GetBakedCurves();
+
 	if (TimeSinceFired > SpreadRecoveryCooldownDelay)
 	{
-		const float CooldownRate = HeatToCoolDownPerSecondCurve.GetRichCurveConst()->Eval(CurrentHeat);
+		const float CooldownRate = EvalBakedCurve(Baked.HeatToCoolDownPerSecond, HeatToCoolDownPerSecondCurve, CurrentHeat);
 		CurrentHeat = ClampHeat(CurrentHeat - (CooldownRate * DeltaSeconds));
-		CurrentSpreadAngle = HeatToSpreadCurve.GetRichCurveConst()->Eval(CurrentHeat);
+		CurrentSpreadAngle = EvalBakedCurve(Baked.HeatToSpread, HeatToSpreadCurve, CurrentHeat);
 	}
-	
-	float MinSpread;
-	float MaxSpread;
-	ComputeSpreadRange(/*out*/ MinSpread, /*out*/ MaxSpread);
 
-	return FMath::IsNearlyEqual(CurrentSpreadAngle, MinSpread, KINDA_SMALL_NUMBER);
+	return FMath::IsNearlyEqual(CurrentSpreadAngle, Baked.MinSpread, KINDA_SMALL_NUMBER);
 }
 
 bool ULyraRangedWeaponInstance::UpdateMultipliers(float DeltaSeconds)
@@ -216,3 +356,79 @@ bool ULyraRangedWeaponInstance::UpdateMultipliers(float DeltaSeconds)
 	return bStandingStillMultiplierAtMin && bCrouchingMultiplierAtTarget && bJumpFallMultiplerIs1 && bAimingMultiplierAtTarget;
 }
 
+
+#if !UE_BUILD_SHIPPING
+void ULyraRangedWeaponInstance::BenchmarkBakedCurves(int32 NumEvaluations, FOutputDevice& Ar)
+{
+	const FLyraRangedWeaponBakedCurves& Baked = GetBakedCurves();
+
+	struct FCurvePair
+	{
+		const TCHAR* Name;
+		const FLyraBakedCurveLUT& LUT;
+		const FRuntimeFloatCurve& Curve;
+		float MinTime;
+		float MaxTime;
+	};
+
+	const FCurvePair CurvePairs[] =
+	{
+		{ TEXT("HeatToHeatPerShot"), Baked.HeatToHeatPerShot, HeatToHeatPerShotCurve, Baked.MinHeat, Baked.MaxHeat },
+		{ TEXT("HeatToCoolDownPerSecond"), Baked.HeatToCoolDownPerSecond, HeatToCoolDownPerSecondCurve, Baked.MinHeat, Baked.MaxHeat },
+		{ TEXT("HeatToSpread"), Baked.HeatToSpread, HeatToSpreadCurve, Baked.MinHeat, Baked.MaxHeat },
+		{ TEXT("DistanceDamageFalloff"), Baked.DistanceDamageFalloff, DistanceDamageFalloff, 0.0f, MaxDamageRange },
+	};
+
+	Ar.Logf(TEXT("%s (%d evaluations per curve)"), *GetClass()->GetName(), NumEvaluations);
+
+	// Use the same pseudo-random sample times for both paths
+	TArray<float> SampleAlphas;
+	SampleAlphas.SetNumUninitialized(NumEvaluations);
+	FRandomStream RandomStream(NumEvaluations);
+	for (float& Alpha : SampleAlphas)
+	{
+		Alpha = RandomStream.GetFraction();
+	}
+
+	for (const FCurvePair& Pair : CurvePairs)
+	{
+		if (!Pair.LUT.IsValid())
+		{
+			Ar.Logf(TEXT("  %-24s no data"), Pair.Name);
+			continue;
+		}
+
+		const FRichCurve* RichCurve = Pair.Curve.GetRichCurveConst();
+
+		float ExactSum = 0.0f;
+		const double ExactStartTime = FPlatformTime::Seconds();
+		for (const float Alpha : SampleAlphas)
+		{
+			ExactSum += RichCurve->Eval(FMath::Lerp(Pair.MinTime, Pair.MaxTime, Alpha));
+		}
+		const double ExactSeconds = FPlatformTime::Seconds() - ExactStartTime;
+
+		float BakedSum = 0.0f;
+		const double BakedStartTime = FPlatformTime::Seconds();
+		for (const float Alpha : SampleAlphas)
+		{
+			BakedSum += Pair.LUT.Eval(FMath::Lerp(Pair.MinTime, Pair.MaxTime, Alpha));
+		}
+		const double BakedSeconds = FPlatformTime::Seconds() - BakedStartTime;
+
+		float MaxError = 0.0f;
+		for (const float Alpha : SampleAlphas)
+		{
+			const float Time = FMath::Lerp(Pair.MinTime, Pair.MaxTime, Alpha);
+			MaxError = FMath::Max(MaxError, FMath::Abs(RichCurve->Eval(Time) - Pair.LUT.Eval(Time)));
+		}
+
+		Ar.Logf(TEXT("  %-24s exact %7.2f ns  baked %7.2f ns  max error %.5f  (checksum delta %.3f)"),
+			Pair.Name,
+			(ExactSeconds * 1.0e9) / NumEvaluations,
+			(BakedSeconds * 1.0e9) / NumEvaluations,
+			MaxError,
+			ExactSum - BakedSum);
+	}
+}
+#endif
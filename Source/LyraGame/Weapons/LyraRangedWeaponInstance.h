@@ -11,6 +11,63 @@
 
 class UPhysicalMaterial;
 
+/**
+ * FLyraBakedCurveLUT
+ *
+ * A rich curve resampled into a fixed number of uniformly spaced samples over a time range,
+ * evaluated with a single linear interpolation instead of a key search + cubic evaluation
+ */
+struct FLyraBakedCurveLUT
+{
+	static constexpr int32 NumSamples = 256;
+
+	void Bake(const FRichCurve& Curve, float InMinTime, float InMaxTime);
+
+	bool IsValid() const
+	{
+		return bValid;
+	}
+
+	// Returns true if the LUT can answer for the specified time (otherwise the exact curve should be evaluated)
+	bool Covers(float Time) const
+	{
+		return bValid && (Time >= MinTime) && (Time <= MaxTime);
+	}
+
+	float Eval(float Time) const
+	{
+		const float Position = FMath::Clamp((Time - MinTime) * InvSampleStep, 0.0f, float(NumSamples - 1));
+		const int32 Index = FMath::Min(FMath::FloorToInt32(Position), NumSamples - 2);
+		return FMath::Lerp(Samples[Index], Samples[Index + 1], Position - float(Index));
+	}
+
+private:
+	float Samples[NumSamples] = {};
+	float MinTime = 0.0f;
+	float MaxTime = 0.0f;
+	float InvSampleStep = 0.0f;
+	bool bValid = false;
+};
+
+/**
+ * FLyraRangedWeaponBakedCurves
+ *
+ * The heat, spread and falloff curves of a ranged weapon class baked into LUTs (along with other derived lookups),
+ * built once per weapon class and shared by every instance of it
+ */
+struct FLyraRangedWeaponBakedCurves
+{
+	FLyraBakedCurveLUT HeatToHeatPerShot;
+	FLyraBakedCurveLUT HeatToCoolDownPerSecond;
+	FLyraBakedCurveLUT HeatToSpread;
+	FLyraBakedCurveLUT DistanceDamageFalloff;
+
+	float MinHeat = 0.0f;
+	float MaxHeat = 0.0f;
+	float MinSpread = 0.0f;
+	float MaxSpread = 0.0f;
+};
+
 /**
  * ULyraRangedWeaponInstance
  *
@@ -68,6 +125,27 @@ public:
 		return BulletTraceSweepRadius;
 	}
 
+	/** Returns true if this weapon fires simulated projectiles rather than instant hit traces */
+	bool IsProjectileWeapon() const
+	{
+		return ProjectileSpeed > 0.0f;
+	}
+
+	float GetProjectileSpeed() const
+	{
+		return ProjectileSpeed;
+	}
+
+	float GetProjectileGravityScale() const
+	{
+		return ProjectileGravityScale;
+	}
+
+	float GetProjectileMaxLifetime() const
+	{
+		return ProjectileMaxLifetime;
+	}
+
 protected:
 #if WITH_EDITORONLY_DATA
 	UPROPERTY(VisibleAnywhere, Category = "Spread|Fire Params")
@@ -178,6 +256,19 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Weapon Config", meta=(ForceUnits=cm))
 	float BulletTraceSweepRadius = 0.0f;
 
+	// Initial speed of the projectiles fired by this weapon (0.0 will result in instant hit traces instead of projectiles)
+	// Projectiles are swept with BulletTraceSweepRadius
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Weapon Config|Projectile", meta=(ForceUnits="cm/s", ClampMin=0.0))
+	float ProjectileSpeed = 0.0f;
+
+	// Multiplier on world gravity for projectiles fired by this weapon
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Weapon Config|Projectile", meta=(EditCondition="ProjectileSpeed > 0"))
+	float ProjectileGravityScale = 1.0f;
+
+	// Time after which a projectile that hasn't hit anything expires (in seconds)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Weapon Config|Projectile", meta=(ForceUnits=s, ClampMin=0.0, EditCondition="ProjectileSpeed > 0"))
+	float ProjectileMaxLifetime = 5.0f;
+
 	// A curve that maps the distance (in cm) to a multiplier on the base damage from the associated gameplay effect
 	// If there is no data in this curve, then the weapon is assumed to have no falloff with distance
 	UPROPERTY(EditAnywhere, Category = "Weapon Config")
@@ -214,6 +305,14 @@ private:
 	// The current crouching multiplier
 	float CrouchingMultiplier = 1.0f;
 
+	// Baked versions of the curves above, shared with (and owned by) the class default object
+	mutable TSharedPtr<const FLyraRangedWeaponBakedCurves> BakedCurves;
+
+	// Combined MaterialDamageMultiplier for each physical material hit so far, filled in on demand
+	// (flushed whenever physical material tags change, see UPhysicalMaterialWithTags::GetTagsGeneration)
+	mutable TMap<TObjectKey<UPhysicalMaterial>, float> PhysicalMaterialMultipliers;
+	mutable uint32 PhysicalMaterialTagsGeneration = 0;
+
 public:
 	void Tick(float DeltaSeconds);
 
@@ -229,17 +328,28 @@ public:
 	virtual float GetPhysicalMaterialAttenuation(const UPhysicalMaterial* PhysicalMaterial, const FGameplayTagContainer* SourceTags = nullptr, const FGameplayTagContainer* TargetTags = nullptr) const override;
 	//~End of ILyraAbilitySourceInterface interface
 
+#if !UE_BUILD_SHIPPING
+	// Compares the cost and accuracy of the baked curves against evaluating the source curves directly
+	void BenchmarkBakedCurves(int32 NumEvaluations, FOutputDevice& Ar);
+#endif
+
 private:
-	void ComputeSpreadRange(float& MinSpread, float& MaxSpread);
-	void ComputeHeatRange(float& MinHeat, float& MaxHeat);
+	void ComputeSpreadRange(float& MinSpread, float& MaxSpread) const;
+	void ComputeHeatRange(float& MinHeat, float& MaxHeat) const;
+
+	// Returns the baked curves for this weapon class, building them on the class default object if needed
+	const FLyraRangedWeaponBakedCurves& GetBakedCurves() const;
+	TSharedPtr<const FLyraRangedWeaponBakedCurves> BuildBakedCurves() const;
+
+	float ComputePhysicalMaterialAttenuation(const UPhysicalMaterial* PhysicalMaterial) const;
+
+	// Evaluates a curve through its baked LUT, falling back to the exact curve when out of range or when Lyra.Weapon.UseExactCurves is set
+	static float EvalBakedCurve(const FLyraBakedCurveLUT& LUT, const FRuntimeFloatCurve& Curve, float Time);
 
 	inline float ClampHeat(float NewHeat)
 	{
-		float MinHeat;
-		float MaxHeat;
-		ComputeHeatRange(/*out*/ MinHeat, /*out*/ MaxHeat);
-
-		return FMath::Clamp(NewHeat, MinHeat, MaxHeat);
+		const FLyraRangedWeaponBakedCurves& Baked = GetBakedCurves();
+		return FMath::Clamp(NewHeat, Baked.MinHeat, Baked.MaxHeat);
 	}
 
 	// Updates the spread and returns true if the spread is at minimum
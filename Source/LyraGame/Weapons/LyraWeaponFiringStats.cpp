@@ -0,0 +1,41 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Weapons/LyraWeaponFiringStats.h"
+
+FLyraWeaponFiringStats& FLyraWeaponFiringStats::Get()
+{
+	static FLyraWeaponFiringStats Instance;
+	return Instance;
+}
+
+const TCHAR* FLyraWeaponFiringStats::GetStageName(ELyraWeaponFiringStage Stage)
+{
+	switch (Stage)
+	{
+	case ELyraWeaponFiringStage::PerformLocalTargeting: return TEXT("PerformLocalTargeting");
+	case ELyraWeaponFiringStage::DoSingleBulletTrace: return TEXT("DoSingleBulletTrace");
+	case ELyraWeaponFiringStage::OnTargetDataReady: return TEXT("OnTargetDataReady");
+	case ELyraWeaponFiringStage::DamageExecution: return TEXT("DamageExecution");
+	case ELyraWeaponFiringStage::GameplayCueDispatch: return TEXT("GameplayCueDispatch");
+	default: return TEXT("Unknown");
+	}
+}
+
+void FLyraWeaponFiringStats::BeginCapture()
+{
+	check(IsInGameThread());
+
+	for (FStageTotals& Totals : StageTotals)
+	{
+		Totals = FStageTotals();
+	}
+	NumShots = 0;
+	NumBulletsFired = 0;
+	bCapturing = true;
+}
+
+void FLyraWeaponFiringStats::EndCapture()
+{
+	check(IsInGameThread());
+	bCapturing = false;
+}
@@ -0,0 +1,98 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "HAL/PlatformTime.h"
+
+// The stages of the weapon firing pipeline that are measured by FLyraWeaponFiringStats
+enum class ELyraWeaponFiringStage : uint8
+{
+	PerformLocalTargeting,
+	DoSingleBulletTrace,
+	OnTargetDataReady,
+	DamageExecution,
+	GameplayCueDispatch,
+
+	Count
+};
+
+/**
+ * FLyraWeaponFiringStats
+ *
+ * Accumulates time spent in each stage of the weapon firing pipeline while a capture is active.
+ * Used by the weapon firing benchmark (see ULyraTestControllerWeaponFiring); costs a single bool check when not capturing.
+ */
+class LYRAGAME_API FLyraWeaponFiringStats
+{
+public:
+	struct FStageTotals
+	{
+		uint64 Cycles = 0;
+		int32 Calls = 0;
+	};
+
+	static FLyraWeaponFiringStats& Get();
+
+	static const TCHAR* GetStageName(ELyraWeaponFiringStage Stage);
+
+	void BeginCapture();
+	void EndCapture();
+
+	bool IsCapturing() const
+	{
+		return bCapturing;
+	}
+
+	void AddStageTime(ELyraWeaponFiringStage Stage, uint64 Cycles)
+	{
+		FStageTotals& Totals = StageTotals[(int32)Stage];
+		Totals.Cycles += Cycles;
+		Totals.Calls++;
+	}
+
+	// Records a fired cartridge and the number of bullets it contained
+	void AddShot(int32 NumBullets)
+	{
+		if (bCapturing)
+		{
+			NumShots++;
+			NumBulletsFired += NumBullets;
+		}
+	}
+
+	const FStageTotals& GetStageTotals(ELyraWeaponFiringStage Stage) const
+	{
+		return StageTotals[(int32)Stage];
+	}
+
+	int32 GetNumShots() const { return NumShots; }
+	int32 GetNumBullets() const { return NumBulletsFired; }
+
+private:
+	FStageTotals StageTotals[(int32)ELyraWeaponFiringStage::Count];
+	int32 NumShots = 0;
+	int32 NumBulletsFired = 0;
+	bool bCapturing = false;
+};
+
+// Times the enclosing scope into the specified stage of FLyraWeaponFiringStats (game thread only)
+struct FLyraWeaponFiringStatScope
+{
+	explicit FLyraWeaponFiringStatScope(ELyraWeaponFiringStage InStage)
+		: Stage(InStage)
+		, StartCycles(FLyraWeaponFiringStats::Get().IsCapturing() ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FLyraWeaponFiringStatScope()
+	{
+		if (StartCycles != 0)
+		{
+			FLyraWeaponFiringStats::Get().AddStageTime(Stage, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+	ELyraWeaponFiringStage Stage;
+	uint64 StartCycles;
+};
@@ -6,16 +6,15 @@
 #include "Equipment/LyraEquipmentManagerComponent.h"
 #include "GameFramework/Pawn.h"
 #include "GameplayEffectTypes.h"
-#include "Kismet/GameplayStatics.h"
-#include "NativeGameplayTags.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "SceneView.h"
 #include "Physics/PhysicalMaterialWithTags.h"
 #include "Teams/LyraTeamSubsystem.h"
 #include "Weapons/LyraRangedWeaponInstance.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraWeaponStateComponent)
 
-UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Gameplay_Zone, "Gameplay.Zone");
-
 ULyraWeaponStateComponent::ULyraWeaponStateComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -65,70 +64,123 @@ bool ULyraWeaponStateComponent::ShouldUpdateDamageInstigatedTime(const FGameplay
 
 void ULyraWeaponStateComponent::ClientConfirmTargetData_Implementation(uint16 UniqueId, bool bSuccess, const TArray<uint8>& HitReplaces)
 {
-	for (int i = 0; i < UnconfirmedServerSideHitMarkers.Num(); i++)
+	FLyraServerSideHitMarkerBatch& Batch = UnconfirmedServerSideHitMarkers[(uint8)UniqueId];
+	if (!Batch.bPending)
+	{
+		return;
+	}
+
+	if (bSuccess && (HitReplaces.Num() != Batch.Markers.Num()))
 	{
-		FLyraServerSideHitMarkerBatch& Batch = UnconfirmedServerSideHitMarkers[i];
-		if (Batch.UniqueId == UniqueId)
+		// Flatten the replaced indices into a bitmask so each marker is a single lookup
+		TBitArray<TInlineAllocator<4>> ReplacedHits(false, Batch.Markers.Num());
+		for (const uint8 ReplacedIndex : HitReplaces)
 		{
-			if (bSuccess && (HitReplaces.Num() != Batch.Markers.Num()))
+			if (ReplacedIndex < Batch.Markers.Num())
 			{
-				UWorld* World = GetWorld();
-				bool bFoundShowAsSuccessHit = false;
+				ReplacedHits[ReplacedIndex] = true;
+			}
+		}
 
-				int32 HitLocationIndex = 0;
-				for (const FLyraScreenSpaceHitLocation& Entry : Batch.Markers)
+		bool bFoundShowAsSuccessHit = false;
+
+		for (int32 HitLocationIndex = 0; HitLocationIndex < Batch.Markers.Num(); ++HitLocationIndex)
+		{
+			const FLyraWorldSpaceHitLocation& Entry = Batch.Markers[HitLocationIndex];
+			if (!ReplacedHits[HitLocationIndex] && Entry.bShowAsSuccess)
+			{
+				// Only need to do this once
+				if (!bFoundShowAsSuccessHit)
 				{
-					if (!HitReplaces.Contains(HitLocationIndex) && Entry.bShowAsSuccess)
-					{
-						// Only need to do this once
-						if (!bFoundShowAsSuccessHit)
-						{
-							ActuallyUpdateDamageInstigatedTime();
-						}
-
-						bFoundShowAsSuccessHit = true;
-
-						LastWeaponDamageScreenLocations.Add(Entry);
-					}
-					++HitLocationIndex;
+					ActuallyUpdateDamageInstigatedTime();
 				}
-			}
 
-			UnconfirmedServerSideHitMarkers.RemoveAt(i);
-			break;
+				bFoundShowAsSuccessHit = true;
+
+				LastWeaponDamageWorldLocations.Add(Entry);
+			}
 		}
 	}
+
+	Batch.Markers.Reset();
+	Batch.bPending = false;
 }
 
 void ULyraWeaponStateComponent::AddUnconfirmedServerSideHitMarkers(const FGameplayAbilityTargetDataHandle& InTargetData, const TArray<FHitResult>& FoundHits)
 {
-	FLyraServerSideHitMarkerBatch& NewUnconfirmedHitMarker = UnconfirmedServerSideHitMarkers.Emplace_GetRef(InTargetData.UniqueId);
+	FLyraServerSideHitMarkerBatch& NewUnconfirmedHitMarker = UnconfirmedServerSideHitMarkers[InTargetData.UniqueId];
+	NewUnconfirmedHitMarker.Markers.Reset();
+	NewUnconfirmedHitMarker.bPending = true;
+	NextHitMarkerBatchId = InTargetData.UniqueId + 1;
 
-	if (APlayerController* OwnerPC = GetController<APlayerController>())
+	// Projection to the screen is deferred until the markers are drawn (see GetLastWeaponDamageScreenLocations)
+	if (GetController<APlayerController>() != nullptr)
 	{
+		NewUnconfirmedHitMarker.Markers.Reserve(FoundHits.Num());
+
 		for (const FHitResult& Hit : FoundHits)
 		{
-			FVector2D HitScreenLocation;
-			if (UGameplayStatics::ProjectWorldToScreen(OwnerPC, Hit.Location, /*out*/ HitScreenLocation, /*bPlayerViewportRelative=*/ false))
-			{
-				FLyraScreenSpaceHitLocation& Entry = NewUnconfirmedHitMarker.Markers.AddDefaulted_GetRef();
-				Entry.Location = HitScreenLocation;
-				Entry.bShowAsSuccess = ShouldShowHitAsSuccess(Hit);
+			InitHitMarker(NewUnconfirmedHitMarker.Markers.AddDefaulted_GetRef(), Hit);
+		}
+	}
+}
 
-				// Determine the hit zone
-				FGameplayTag HitZone;
-				if (const UPhysicalMaterialWithTags* PhysMatWithTags = Cast<const UPhysicalMaterialWithTags>(Hit.PhysMaterial.Get()))
-				{
-					for (const FGameplayTag MaterialTag : PhysMatWithTags->Tags)
-					{
-						if (MaterialTag.MatchesTag(TAG_Gameplay_Zone))
-						{
-							Entry.HitZone = MaterialTag;
-							break;
-						}
-					}
-				}
-			}
+void ULyraWeaponStateComponent::UpdateUnconfirmedServerSideHitMarker(uint8 UniqueId, int32 MarkerIndex, const FHitResult& Hit)
+{
+	FLyraServerSideHitMarkerBatch& Batch = UnconfirmedServerSideHitMarkers[UniqueId];
+	if (Batch.bPending && Batch.Markers.IsValidIndex(MarkerIndex))
+	{
+		InitHitMarker(Batch.Markers[MarkerIndex], Hit);
+	}
+}
+
+void ULyraWeaponStateComponent::InitHitMarker(FLyraWorldSpaceHitLocation& Entry, const FHitResult& Hit) const
+{
+	Entry.Location = Hit.Location;
+	Entry.bShowAsSuccess = ShouldShowHitAsSuccess(Hit);
+
+	// Determine the hit zone
+	const UPhysicalMaterialWithTags* PhysMatWithTags = Cast<const UPhysicalMaterialWithTags>(Hit.PhysMaterial.Get());
+	Entry.HitZone = (PhysMatWithTags != nullptr) ? PhysMatWithTags->GetHitZone() : FGameplayTag();
+}
+
+void ULyraWeaponStateComponent::GetLastWeaponDamageScreenLocations(TArray<FLyraScreenSpaceHitLocation>& WeaponDamageScreenLocations) const
+{
+	WeaponDamageScreenLocations.Reset();
+
+	if (LastWeaponDamageWorldLocations.Num() == 0)
+	{
+		return;
+	}
+
+	APlayerController* OwnerPC = GetController<APlayerController>();
+	ULocalPlayer* LocalPlayer = (OwnerPC != nullptr) ? OwnerPC->GetLocalPlayer() : nullptr;
+	if ((LocalPlayer == nullptr) || (LocalPlayer->ViewportClient == nullptr))
+	{
+		return;
+	}
+
+	// Build the view projection once and project all of the markers with it (equivalent to UGameplayStatics::ProjectWorldToScreen per marker)
+	FSceneViewProjectionData ProjectionData;
+	if (!LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, /*out*/ ProjectionData))
+	{
+		return;
+	}
+
+	const FMatrix ViewProjectionMatrix = ProjectionData.ComputeViewProjectionMatrix();
+	const FIntRect ViewRect = ProjectionData.GetConstrainedViewRect();
+
+	WeaponDamageScreenLocations.Reserve(LastWeaponDamageWorldLocations.Num());
+	for (const FLyraWorldSpaceHitLocation& Marker : LastWeaponDamageWorldLocations)
+	{
+		FVector2D HitScreenLocation;
+		if (FSceneView::ProjectWorldToScreen(Marker.Location, ViewRect, ViewProjectionMatrix, /*out*/ HitScreenLocation) &&
+			OwnerPC->PostProcessWorldToScreen(Marker.Location, /*inout*/ HitScreenLocation, /*bPlayerViewportRelative=*/ false))
+		{
+			FLyraScreenSpaceHitLocation& Entry = WeaponDamageScreenLocations.AddDefaulted_GetRef();
+			Entry.Location = HitScreenLocation;
+			Entry.HitZone = Marker.HitZone;
+			Entry.bShowAsSuccess = Marker.bShowAsSuccess;
 		}
 	}
 }
@@ -147,7 +199,7 @@ void ULyraWeaponStateComponent::ActuallyUpdateDamageInstigatedTime()
 	UWorld* World = GetWorld();
 	if (World->GetTimeSeconds() - LastWeaponDamageInstigatedTime > 0.1)
 	{
-		LastWeaponDamageScreenLocations.Reset();
+		LastWeaponDamageWorldLocations.Reset();
 	}
 	LastWeaponDamageInstigatedTime = World->GetTimeSeconds();
 }
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Components/ControllerComponent.h"
+#include "Containers/StaticArray.h"
 #include "GameplayTagContainer.h"
 
 #include "LyraWeaponStateComponent.generated.h"
@@ -23,17 +24,22 @@ struct FLyraScreenSpaceHitLocation
 	bool bShowAsSuccess = false;
 };
 
-struct FLyraServerSideHitMarkerBatch
+// A hit marker as it is stored, before being projected to the screen when drawn
+struct FLyraWorldSpaceHitLocation
 {
-	FLyraServerSideHitMarkerBatch() { }
-
-	FLyraServerSideHitMarkerBatch(uint8 InUniqueId) :
-		UniqueId(InUniqueId)
-	{ }
+	/** Hit location in world space */
+	FVector Location;
+	FGameplayTag HitZone;
+	bool bShowAsSuccess = false;
+};
 
-	TArray<FLyraScreenSpaceHitLocation> Markers;
+struct FLyraServerSideHitMarkerBatch
+{
+	// One entry per target data entry in the batch (so the server's HitReplaces indices line up)
+	TArray<FLyraWorldSpaceHitLocation> Markers;
 
-	uint8 UniqueId = 0;
+	// Is this batch waiting on ClientConfirmTargetData?
+	bool bPending = false;
 };
 
 // Tracks weapon state and recent confirmed hit markers to display on screen
@@ -53,21 +59,22 @@ public:
 
 	void AddUnconfirmedServerSideHitMarkers(const FGameplayAbilityTargetDataHandle& InTargetData, const TArray<FHitResult>& FoundHits);
 
+	/** Replaces a single marker in a batch that is still waiting for confirmation (used by projectiles, which hit after the batch was added) */
+	void UpdateUnconfirmedServerSideHitMarker(uint8 UniqueId, int32 MarkerIndex, const FHitResult& Hit);
+
 	/** Updates this player's last damage instigated time */
 	void UpdateDamageInstigatedTime(const FGameplayEffectContextHandle& EffectContext);
 
-	/** Gets the array of most recent locations this player instigated damage, in screen-space */
-	void GetLastWeaponDamageScreenLocations(TArray<FLyraScreenSpaceHitLocation>& WeaponDamageScreenLocations)
-	{
-		WeaponDamageScreenLocations = LastWeaponDamageScreenLocations;
-	}
+	/** Gets the array of most recent locations this player instigated damage, projected into screen-space (markers that are off screen are skipped) */
+	void GetLastWeaponDamageScreenLocations(TArray<FLyraScreenSpaceHitLocation>& WeaponDamageScreenLocations) const;
 
 	/** Returns the elapsed time since the last (outgoing) damage hit notification occurred */
 	double GetTimeSinceLastHitNotification() const;
 
-	int32 GetUnconfirmedServerSideHitMarkerCount() const
+	/** Returns the unique ID to use for the next batch of target data passed to AddUnconfirmedServerSideHitMarkers */
+	uint8 GetNextHitMarkerBatchId() const
 	{
-		return UnconfirmedServerSideHitMarkers.Num();
+		return NextHitMarkerBatchId;
 	}
 
 protected:
@@ -80,13 +87,18 @@ protected:
 
 	void ActuallyUpdateDamageInstigatedTime();
 
+	void InitHitMarker(FLyraWorldSpaceHitLocation& Entry, const FHitResult& Hit) const;
+
 private:
 	/** Last time this controller instigated weapon damage */
 	double LastWeaponDamageInstigatedTime = 0.0;
 
-	/** Screen-space locations of our most recently instigated weapon damage (the confirmed hits) */
-	TArray<FLyraScreenSpaceHitLocation> LastWeaponDamageScreenLocations;
+	/** World-space locations of our most recently instigated weapon damage (the confirmed hits) */
+	TArray<FLyraWorldSpaceHitLocation> LastWeaponDamageWorldLocations;
+
+	/** The unconfirmed hits, indexed by the target data unique ID (which wraps around) */
+	TStaticArray<FLyraServerSideHitMarkerBatch, 256> UnconfirmedServerSideHitMarkers;
 
-	/** The unconfirmed hits */
-	TArray<FLyraServerSideHitMarkerBatch> UnconfirmedServerSideHitMarkers;
+	/** The unique ID that will be used for the next batch of unconfirmed hits */
+	uint8 NextHitMarkerBatchId = 0;
 };